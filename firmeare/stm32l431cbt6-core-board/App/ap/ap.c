@@ -19,5 +19,13 @@ void apMain(void)
 			ledToggle(_DEF_LED1);
 		}
 		cliMain();
+		logUpdate();
+
+		// 라인 모드에서 받은 줄이 없으면 CR 매치나 SysTick 인터럽트까지 잠든다.
+		//
+		if (cliIsIdle() == true)
+		{
+			__WFI();
+		}
 	}
 }
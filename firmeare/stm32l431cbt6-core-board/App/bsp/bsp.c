@@ -2,11 +2,45 @@
 #include "hw_def.h"
 
 
+// micros64() 는 DWT CYCCNT 를 64비트로 늘린 사이클 수로 계산한다.
+// SysTick 마다 지난 사이클을 더하므로 ISR 이 늦게 돌아도 값이 뒤로 가지 않는다.
+// CYCCNT 는 80MHz 에서 약 53초마다 넘치므로 그 안에 한 번만 더해지면 된다.
+//
+static volatile uint64_t tick_cyc64 = 0;
+static volatile uint32_t tick_cyc_last = 0;
+
+
 bool bspInit(void)
 {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  tick_cyc64    = 0;
+  tick_cyc_last = DWT->CYCCNT;
+
   return true;
 }
 
+// SysTick_Handler() 에서 HAL_IncTick() 다음에 호출한다.
+//
+void bspTickISR(void)
+{
+  uint32_t cyc;
+  uint32_t primask;
+
+
+  // SysTick 은 우선순위가 가장 낮아 갱신 중에 다른 인터럽트가 micros64() 를 부를 수 있다.
+  //
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  cyc = DWT->CYCCNT;
+  tick_cyc64   += (uint32_t)(cyc - tick_cyc_last);
+  tick_cyc_last = cyc;
+
+  __set_PRIMASK(primask);
+}
+
 void delay(uint32_t ms)
 {
 #ifdef _USE_HW_RTOS
@@ -28,3 +62,26 @@ uint32_t millis(void)
   return HAL_GetTick();
 }
 
+uint64_t micros64(void)
+{
+  uint64_t cyc;
+  uint32_t primask;
+
+
+  // 누적값과 CYCCNT 를 한 번에 읽는다. SysTick 이 밀려 있으면 지난 사이클이 그만큼 클 뿐이다.
+  //
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  cyc = tick_cyc64 + (uint32_t)(DWT->CYCCNT - tick_cyc_last);
+
+  __set_PRIMASK(primask);
+
+  return cyc / (SystemCoreClock / 1000000);
+}
+
+uint32_t micros(void)
+{
+  return (uint32_t)micros64();
+}
+
@@ -10,11 +10,14 @@ extern "C" {
 
 
 bool bspInit(void);
+void bspTickISR(void);
 
 void logPrintf(const char *fmt, ...);
 
 void delay(uint32_t time_ms);
 uint32_t millis(void);
+uint32_t micros(void);
+uint64_t micros64(void);
 
 
 #ifdef __cplusplus
@@ -1,22 +1,66 @@
 #include "qbuffer.h"
+#ifdef _USE_HW_CLI
+#include "cli.h"
+#endif
+
+
+
+#ifdef _USE_HW_QBUFFER_STATS
+#define QBUFFER_STATS_MAX     HW_QBUFFER_STATS_MAX
+
+static qbuffer_t *qbuffer_list[QBUFFER_STATS_MAX];
+static uint8_t    qbuffer_list_cnt = 0;
+
+static void qbufferStatsWrite(qbuffer_t *p_node, uint32_t length, bool is_ovf);
+#endif
+
+#if defined(_USE_HW_QBUFFER_STATS) && defined(_USE_HW_CLI)
+static void cliQbuffer(cli_args_t *args);
+#endif
+
+static uint32_t qbufferNext(qbuffer_t *p_node, uint32_t index, uint32_t count);
+static uint32_t qbufferCount(qbuffer_t *p_node, uint32_t in, uint32_t out);
+static uint32_t qbufferAdvanceOut(qbuffer_t *p_node, uint32_t count);
+static uint32_t qbufferDropOldest(qbuffer_t *p_node, uint32_t length);
 
 
 void qbufferInit(void)
 {
-
+#if defined(_USE_HW_QBUFFER_STATS) && defined(_USE_HW_CLI)
+  cliAdd("qbuffer", cliQbuffer);
+#endif
 }
 
-bool qbufferCreate(qbuffer_t *p_node, uint8_t *p_buf, uint32_t length)
+// 통계 목록(qbuffer info)에 등록한다. qbufferCreate() 이후에 호출한다.
+//
+bool qbufferRegister(qbuffer_t *p_node, const char *p_name)
 {
-  bool ret = true;
+#ifdef _USE_HW_QBUFFER_STATS
+  p_node->p_name = p_name;
 
-  p_node->in    = 0;
-  p_node->out   = 0;
-  p_node->len   = length;
-  p_node->size  = 1;
-  p_node->p_buf = p_buf;
+  for (int i=0; i<qbuffer_list_cnt; i++)
+  {
+    if (qbuffer_list[i] == p_node)
+    {
+      return true;
+    }
+  }
 
-  return ret;
+  if (qbuffer_list_cnt >= QBUFFER_STATS_MAX)
+  {
+    return false;
+  }
+  qbuffer_list[qbuffer_list_cnt++] = p_node;
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool qbufferCreate(qbuffer_t *p_node, uint8_t *p_buf, uint32_t length)
+{
+  return qbufferCreateBySize(p_node, p_buf, 1, length);
 }
 
 bool qbufferCreateBySize(qbuffer_t *p_node, uint8_t *p_buf, uint32_t size, uint32_t length)
@@ -29,75 +73,231 @@ bool qbufferCreateBySize(qbuffer_t *p_node, uint8_t *p_buf, uint32_t size, uint3
   p_node->size  = size;
   p_node->p_buf = p_buf;
 
+  p_node->is_overwrite = false;
+  p_node->drop_cnt     = 0;
+
+#ifdef _USE_HW_QBUFFER_STATS
+  p_node->p_name    = NULL;
+  p_node->peak      = 0;
+  p_node->write_cnt = 0;
+  p_node->read_cnt  = 0;
+  p_node->ovf_cnt   = 0;
+#endif
+
+  // 길이가 2의 거듭제곱이면 % 대신 마스크로 인덱스를 계산한다.
+  //
+  if (length > 1 && (length & (length - 1)) == 0)
+    p_node->mask = length - 1;
+  else
+    p_node->mask = 0;
+
   return ret;
 }
 
+void qbufferSetOverwrite(qbuffer_t *p_node, bool enable)
+{
+  p_node->is_overwrite = enable;
+}
+
+uint32_t qbufferGetDropCount(qbuffer_t *p_node)
+{
+  return p_node->drop_cnt;
+}
+
+uint32_t qbufferNext(qbuffer_t *p_node, uint32_t index, uint32_t count)
+{
+  if (p_node->mask != 0)
+  {
+    return (index + count) & p_node->mask;
+  }
+
+  index += count;
+  if (index >= p_node->len)
+  {
+    index -= p_node->len;
+  }
+  return index;
+}
+
+uint32_t qbufferCount(qbuffer_t *p_node, uint32_t in, uint32_t out)
+{
+  if (p_node->mask != 0)
+  {
+    return (in - out) & p_node->mask;
+  }
+  return (p_node->len + in - out) % p_node->len;
+}
+
+// overwrite 모드에서는 생산자와 소비자가 모두 out 을 움직이므로
+// LDREX/STREX 로 out 을 원자적으로 count 만큼(저장된 개수 이내) 전진시킨다.
+//
+uint32_t qbufferAdvanceOut(qbuffer_t *p_node, uint32_t count)
+{
+  uint32_t out;
+  uint32_t n;
+
+  do
+  {
+    out = __LDREXW(&p_node->out);
+    n   = cmin(count, qbufferCount(p_node, p_node->in, out));
+  } while (__STREXW(qbufferNext(p_node, out, n), &p_node->out) != 0);
+
+  return n;
+}
+
+// length 개를 쓸 자리가 생길 때까지 가장 오래된 데이터를 버리고, 버린 개수를 돌려준다.
+//
+uint32_t qbufferDropOldest(qbuffer_t *p_node, uint32_t length)
+{
+  uint32_t out;
+  uint32_t w_len;
+  uint32_t n;
+
+  do
+  {
+    out   = __LDREXW(&p_node->out);
+    w_len = p_node->len - 1 - qbufferCount(p_node, p_node->in, out);
+    n     = (length > w_len) ? (length - w_len) : 0;
+  } while (__STREXW(qbufferNext(p_node, out, n), &p_node->out) != 0);
+
+  return n;
+}
+
 bool qbufferWrite(qbuffer_t *p_node, uint8_t *p_data, uint32_t length)
 {
   bool ret = true;
-  uint32_t next_in;
+  uint32_t in;
+  uint32_t w_len;
+  uint32_t run_len;
 
 
-  for (uint32_t i=0; i<length; i++)
-  {
-    next_in = (p_node->in + 1) % p_node->len;
+  in    = p_node->in;
+  w_len = qbufferAvailableForWrite(p_node);
 
-    if (next_in != p_node->out)
+  if (p_node->is_overwrite == true)
+  {
+    // 버퍼보다 긴 데이터는 뒤쪽(최신) len-1 개만 남긴다.
+    //
+    if (length > p_node->len - 1)
     {
-      if (p_node->p_buf != NULL && p_data != NULL)
+      p_node->drop_cnt += length - (p_node->len - 1);
+      if (p_data != NULL)
       {
-        uint8_t *p_buf;
-
-        p_buf = &p_node->p_buf[p_node->in*p_node->size];
-        for (uint32_t j=0; j<p_node->size; j++)
-        {
-          p_buf[j] = p_data[j];
-        }
-        p_data += p_node->size;
+        p_data += (length - (p_node->len - 1))*p_node->size;
       }
-      p_node->in = next_in;
+      length = p_node->len - 1;
     }
-    else
+
+    // 자리가 모자라면 가장 오래된 데이터를 먼저 버리고 기록한다.
+    //
+    if (length > w_len)
     {
-      ret = false;
-      break;
+      p_node->drop_cnt += qbufferDropOldest(p_node, length);
     }
+    w_len = length;
   }
+  else if (length > w_len)
+  {
+    ret = false;
+  }
+  else
+  {
+    w_len = length;
+  }
+
+  if (p_node->p_buf != NULL && p_data != NULL && w_len > 0)
+  {
+    // 끝까지 이어진 구간과 처음부터의 나머지 구간, 최대 2번의 memcpy로 복사
+    //
+    run_len = cmin(w_len, p_node->len - in);
+
+    memcpy(&p_node->p_buf[in*p_node->size], p_data, run_len*p_node->size);
+    if (run_len < w_len)
+    {
+      memcpy(&p_node->p_buf[0], &p_data[run_len*p_node->size], (w_len - run_len)*p_node->size);
+    }
+  }
+
+  // 데이터 기록이 끝난 뒤에 in 을 공개한다. (release)
+  //
+  __DMB();
+  p_node->in = qbufferNext(p_node, in, w_len);
+
+#ifdef _USE_HW_QBUFFER_STATS
+  qbufferStatsWrite(p_node, w_len, !ret);
+#endif
 
   return ret;
 }
 
 bool qbufferRead(qbuffer_t *p_node, uint8_t *p_data, uint32_t length)
 {
-  bool ret = true;
+  bool ret;
+  uint32_t out;
+  uint32_t next_out;
+  uint32_t r_len;
+  uint32_t run_len;
 
 
-  for (uint32_t i=0; i<length; i++)
+  while(1)
   {
-    if (p_node->p_buf != NULL && p_data != NULL)
+    ret   = true;
+    out   = p_node->out;
+    r_len = qbufferCount(p_node, p_node->in, out);
+    if (length > r_len)
+    {
+      ret = false;
+    }
+    else
+    {
+      r_len = length;
+    }
+
+    // in 을 읽은 뒤에 데이터를 읽는다. (acquire)
+    //
+    __DMB();
+
+    if (p_node->p_buf != NULL && p_data != NULL && r_len > 0)
     {
-      uint8_t *p_buf;
+      run_len = cmin(r_len, p_node->len - out);
 
-      p_buf = &p_node->p_buf[p_node->out*p_node->size];
-      for (uint32_t j=0; j<p_node->size; j++)
+      memcpy(p_data, &p_node->p_buf[out*p_node->size], run_len*p_node->size);
+      if (run_len < r_len)
       {
-        p_data[j] = p_buf[j];
+        memcpy(&p_data[run_len*p_node->size], &p_node->p_buf[0], (r_len - run_len)*p_node->size);
       }
+    }
+
+    // 데이터를 다 읽은 뒤에 out 을 돌려준다. (release)
+    //
+    __DMB();
+    next_out = qbufferNext(p_node, out, r_len);
 
-      p_data += p_node->size;
+    if (p_node->is_overwrite != true)
+    {
+      p_node->out = next_out;
+      break;
     }
 
-    if (p_node->out != p_node->in)
+    // 복사하는 동안 생산자가 out 을 밀었다면 덮어쓰였을 수 있으므로 다시 읽는다.
+    //
+    if (__LDREXW(&p_node->out) == out)
     {
-      p_node->out = (p_node->out + 1) % p_node->len;
+      if (__STREXW(next_out, &p_node->out) == 0)
+      {
+        break;
+      }
     }
     else
     {
-      ret = false;
-      break;
+      __CLREX();
     }
   }
 
+#ifdef _USE_HW_QBUFFER_STATS
+  p_node->read_cnt += r_len;
+#endif
+
   return ret;
 }
 
@@ -112,18 +312,181 @@ uint8_t *qbufferPeekRead(qbuffer_t *p_node)
 }
 
 
-uint32_t qbufferAvailable(qbuffer_t *p_node)
+// 버퍼 안에서 바로 쓸 수 있는 연속 구간의 시작 주소와 길이(요소 개수)
+// 기록을 마치면 qbufferCommit() 으로 공개한다.
+//
+uint32_t qbufferSpanWrite(qbuffer_t *p_node, uint8_t **p_ptr)
+{
+  uint32_t in = p_node->in;
+
+
+  *p_ptr = &p_node->p_buf[in*p_node->size];
+
+  return cmin(qbufferAvailableForWrite(p_node), p_node->len - in);
+}
+
+// 버퍼 안에서 바로 읽을 수 있는 연속 구간의 시작 주소와 길이(요소 개수)
+// 처리가 끝나면 qbufferConsume() 으로 반납한다.
+//
+uint32_t qbufferSpanRead(qbuffer_t *p_node, uint8_t **p_ptr)
 {
+  uint32_t out = p_node->out;
   uint32_t ret;
 
 
-  ret = (p_node->len + p_node->in - p_node->out) % p_node->len;
+  ret = cmin(qbufferCount(p_node, p_node->in, out), p_node->len - out);
+  __DMB();
+
+  *p_ptr = &p_node->p_buf[out*p_node->size];
 
   return ret;
 }
 
+void qbufferCommit(qbuffer_t *p_node, uint32_t length)
+{
+  length = cmin(length, qbufferAvailableForWrite(p_node));
+
+  __DMB();
+  p_node->in = qbufferNext(p_node, p_node->in, length);
+
+#ifdef _USE_HW_QBUFFER_STATS
+  qbufferStatsWrite(p_node, length, false);
+#endif
+}
+
+// DMA 처럼 버퍼에 직접 기록하는 생산자가 새 in 을 공개할 때 사용한다.
+//
+void qbufferUpdateIn(qbuffer_t *p_node, uint32_t in)
+{
+#ifdef _USE_HW_QBUFFER_STATS
+  uint32_t length;
+#endif
+
+  if (in >= p_node->len)
+  {
+    in = 0;
+  }
+
+#ifdef _USE_HW_QBUFFER_STATS
+  length = qbufferCount(p_node, in, p_node->in);
+#endif
+
+  p_node->in = in;
+
+#ifdef _USE_HW_QBUFFER_STATS
+  qbufferStatsWrite(p_node, length, false);
+#endif
+}
+
+void qbufferConsume(qbuffer_t *p_node, uint32_t length)
+{
+  __DMB();
+
+  if (p_node->is_overwrite == true)
+  {
+    length = qbufferAdvanceOut(p_node, length);
+  }
+  else
+  {
+    length = cmin(length, qbufferAvailable(p_node));
+    p_node->out = qbufferNext(p_node, p_node->out, length);
+  }
+
+#ifdef _USE_HW_QBUFFER_STATS
+  p_node->read_cnt += length;
+#endif
+}
+
+
+uint32_t qbufferAvailable(qbuffer_t *p_node)
+{
+  return qbufferCount(p_node, p_node->in, p_node->out);
+}
+
+uint32_t qbufferAvailableForWrite(qbuffer_t *p_node)
+{
+  return p_node->len - 1 - qbufferAvailable(p_node);
+}
+
 void qbufferFlush(qbuffer_t *p_node)
 {
-  p_node->in  = 0;
-  p_node->out = 0;
+  // 소비자 쪽에서만 호출한다. 생산자의 in 은 건드리지 않는다.
+  //
+  if (p_node->is_overwrite == true)
+  {
+    qbufferAdvanceOut(p_node, p_node->len);
+  }
+  else
+  {
+    p_node->out = p_node->in;
+  }
+}
+
+#ifdef _USE_HW_QBUFFER_STATS
+void qbufferStatsWrite(qbuffer_t *p_node, uint32_t length, bool is_ovf)
+{
+  uint32_t used;
+
+  used = qbufferAvailable(p_node);
+  if (used > p_node->peak)
+  {
+    p_node->peak = used;
+  }
+  p_node->write_cnt += length;
+
+  if (is_ovf)
+  {
+    p_node->ovf_cnt++;
+  }
+}
+#endif
+
+
+#if defined(_USE_HW_QBUFFER_STATS) && defined(_USE_HW_CLI)
+void cliQbuffer(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    cliPrintf("%-18s %6s %6s %6s %4s %10s %10s %6s %6s\n",
+              "name", "len", "used", "peak", "%", "write", "read", "ovf", "drop");
+
+    for (int i=0; i<qbuffer_list_cnt; i++)
+    {
+      qbuffer_t *p_node = qbuffer_list[i];
+
+      cliPrintf("%-18s %6d %6d %6d %3d%% %10u %10u %6u %6u\n",
+                p_node->p_name != NULL ? p_node->p_name : "-",
+                (int)p_node->len - 1,
+                (int)qbufferAvailable(p_node),
+                (int)p_node->peak,
+                (int)(p_node->peak * 100 / (p_node->len - 1)),
+                (unsigned int)p_node->write_cnt,
+                (unsigned int)p_node->read_cnt,
+                (unsigned int)p_node->ovf_cnt,
+                (unsigned int)p_node->drop_cnt);
+    }
+    ret = true;
+  }
+
+  if (args->argc == 1 && args->isStr(0, "clear"))
+  {
+    for (int i=0; i<qbuffer_list_cnt; i++)
+    {
+      qbuffer_list[i]->peak      = qbufferAvailable(qbuffer_list[i]);
+      qbuffer_list[i]->write_cnt = 0;
+      qbuffer_list[i]->read_cnt  = 0;
+      qbuffer_list[i]->ovf_cnt   = 0;
+    }
+    ret = true;
+  }
+
+  if (ret == false)
+  {
+    cliPrintf("qbuffer info\n");
+    cliPrintf("qbuffer clear\n");
+  }
 }
+#endif
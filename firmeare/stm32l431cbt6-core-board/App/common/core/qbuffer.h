@@ -6,16 +6,38 @@ extern "C" {
 #endif
 
 
-#include "def.h"
+#include "hw_def.h"
 
 
 
+// Single-producer / single-consumer 링버퍼
+//
+// - 생산자(ISR, DMA 또는 메인 루프 중 하나)만 in 을 쓰고, 소비자만 out 을 쓴다.
+// - 데이터를 먼저 복사한 뒤 인덱스를 갱신하므로(release) 상대편은 인덱스를 읽은 뒤(acquire)
+//   데이터에 접근하면 되고, 인터럽트를 막을 필요가 없다.
+// - DMA 가 생산자인 경우 드라이버가 CNDTR 에서 계산한 값을 qbufferUpdateIn() 으로 공개한다.
+// - 한 칸은 항상 비워 두므로 최대 len-1 개까지 저장된다.
+// - overwrite 모드에서는 가득 찼을 때 쓰기가 실패하지 않고 가장 오래된 데이터를 버린다.
+//   이때 생산자도 out 을 움직이므로 out 은 LDREX/STREX 로만 갱신하고, 버린 개수는 drop_cnt 에 누적한다.
+//
 typedef struct
 {
-  uint32_t in;
-  uint32_t out;
+  volatile uint32_t in;
+  volatile uint32_t out;
   uint32_t len;
   uint32_t size;
+  uint32_t mask;      // len-1 if len is a power of two, else 0
+
+  bool     is_overwrite;
+  volatile uint32_t drop_cnt;
+
+#ifdef _USE_HW_QBUFFER_STATS
+  const char *p_name;
+  uint32_t peak;          // 최대 저장 개수
+  uint32_t write_cnt;     // 누적 쓰기 개수
+  uint32_t read_cnt;      // 누적 읽기 개수
+  uint32_t ovf_cnt;       // 자리가 없어 실패한 쓰기 횟수
+#endif
 
   uint8_t *p_buf;
 } qbuffer_t;
@@ -24,11 +46,20 @@ typedef struct
 void     qbufferInit(void);
 bool     qbufferCreate(qbuffer_t *p_node, uint8_t *p_buf, uint32_t length);
 bool     qbufferCreateBySize(qbuffer_t *p_node, uint8_t *p_buf, uint32_t size, uint32_t length);
+bool     qbufferRegister(qbuffer_t *p_node, const char *p_name);
+void     qbufferSetOverwrite(qbuffer_t *p_node, bool enable);
+uint32_t qbufferGetDropCount(qbuffer_t *p_node);
 bool     qbufferWrite(qbuffer_t *p_node, uint8_t *p_data, uint32_t length);
 bool     qbufferRead(qbuffer_t *p_node, uint8_t *p_data, uint32_t length);
 uint8_t *qbufferPeekWrite(qbuffer_t *p_node);
 uint8_t *qbufferPeekRead(qbuffer_t *p_node);
+uint32_t qbufferSpanWrite(qbuffer_t *p_node, uint8_t **p_ptr);
+uint32_t qbufferSpanRead(qbuffer_t *p_node, uint8_t **p_ptr);
+void     qbufferCommit(qbuffer_t *p_node, uint32_t length);
+void     qbufferUpdateIn(qbuffer_t *p_node, uint32_t in);
+void     qbufferConsume(qbuffer_t *p_node, uint32_t length);
 uint32_t qbufferAvailable(qbuffer_t *p_node);
+uint32_t qbufferAvailableForWrite(qbuffer_t *p_node);
 void     qbufferFlush(qbuffer_t *p_node);
 
 
@@ -0,0 +1,234 @@
+#include "qrecord.h"
+
+
+
+
+static void     qrecordSetHeader(uint8_t *p_buf, uint16_t length);
+static uint16_t qrecordGetHeader(uint8_t *p_buf);
+
+
+
+bool qrecordCreate(qrecord_t *p_node, uint8_t *p_buf, uint32_t length)
+{
+  p_node->reserve_skip = 0;
+  p_node->reserve_len  = 0;
+
+  return qbufferCreate(&p_node->qbuffer, p_buf, length);
+}
+
+void qrecordSetHeader(uint8_t *p_buf, uint16_t length)
+{
+  p_buf[0] = (length >> 0) & 0xFF;
+  p_buf[1] = (length >> 8) & 0xFF;
+}
+
+uint16_t qrecordGetHeader(uint8_t *p_buf)
+{
+  return (uint16_t)(p_buf[0] | (p_buf[1] << 8));
+}
+
+// length 바이트를 바로 기록할 수 있는 연속 영역을 돌려준다.
+// 자리가 없으면 NULL, 기록을 마치면 qrecordCommit() 을 호출한다.
+//
+uint8_t *qrecordReserve(qrecord_t *p_node, uint32_t length)
+{
+  qbuffer_t *p_q = &p_node->qbuffer;
+  uint32_t in;
+  uint32_t need;
+  uint32_t tail;
+  uint32_t skip = 0;
+
+
+  if (length > QRECORD_LENGTH_MAX)
+  {
+    return NULL;
+  }
+
+  in   = p_q->in;
+  need = QRECORD_HEADER_SIZE + length;
+  tail = p_q->len - in;
+
+  // 끝 구간에 다 들어가지 않으면 끝 구간은 버리고 처음부터 기록한다.
+  //
+  if (tail < need)
+  {
+    skip = tail;
+    in   = 0;
+  }
+
+  if (skip + need > qbufferAvailableForWrite(p_q))
+  {
+    return NULL;
+  }
+
+  p_node->reserve_skip = skip;
+  p_node->reserve_len  = length;
+
+  return &p_q->p_buf[in + QRECORD_HEADER_SIZE];
+}
+
+bool qrecordCommit(qrecord_t *p_node, uint32_t length)
+{
+  qbuffer_t *p_q = &p_node->qbuffer;
+  uint32_t in;
+
+
+  if (length > p_node->reserve_len)
+  {
+    return false;
+  }
+
+  in = p_q->in;
+  if (p_node->reserve_skip > 0)
+  {
+    if (p_node->reserve_skip >= QRECORD_HEADER_SIZE)
+    {
+      qrecordSetHeader(&p_q->p_buf[in], QRECORD_WRAP);
+    }
+    in = 0;
+  }
+  qrecordSetHeader(&p_q->p_buf[in], length);
+
+  qbufferCommit(p_q, p_node->reserve_skip + QRECORD_HEADER_SIZE + length);
+
+  p_node->reserve_skip = 0;
+  p_node->reserve_len  = 0;
+
+  return true;
+}
+
+bool qrecordWrite(qrecord_t *p_node, uint8_t *p_data, uint32_t length)
+{
+  uint8_t *p_buf;
+
+
+  p_buf = qrecordReserve(p_node, length);
+  if (p_buf == NULL)
+  {
+    return false;
+  }
+  memcpy(p_buf, p_data, length);
+
+  return qrecordCommit(p_node, length);
+}
+
+// 가장 오래된 레코드의 길이와 데이터 위치를 돌려준다. 비어 있으면 0.
+// 처리가 끝나면 qrecordRelease() 로 반납한다.
+//
+uint32_t qrecordPeek(qrecord_t *p_node, uint8_t **p_data)
+{
+  qbuffer_t *p_q = &p_node->qbuffer;
+  uint8_t  *p_buf;
+  uint32_t  span;
+  uint16_t  length;
+
+
+  while(1)
+  {
+    span = qbufferSpanRead(p_q, &p_buf);
+    if (span == 0)
+    {
+      return 0;
+    }
+
+    // 헤더가 들어가지 않는 끝 구간이나 WRAP 마커는 건너뛴다.
+    //
+    if (span < QRECORD_HEADER_SIZE)
+    {
+      qbufferConsume(p_q, span);
+      continue;
+    }
+
+    length = qrecordGetHeader(p_buf);
+    if (length == QRECORD_WRAP)
+    {
+      qbufferConsume(p_q, p_q->len - p_q->out);
+      continue;
+    }
+    break;
+  }
+
+  *p_data = &p_buf[QRECORD_HEADER_SIZE];
+
+  return length;
+}
+
+void qrecordRelease(qrecord_t *p_node)
+{
+  uint8_t *p_data;
+  uint32_t length;
+
+
+  if (qbufferAvailable(&p_node->qbuffer) == 0)
+  {
+    return;
+  }
+  length = qrecordPeek(p_node, &p_data);
+
+  qbufferConsume(&p_node->qbuffer, QRECORD_HEADER_SIZE + length);
+}
+
+// 레코드 하나를 p_data 로 복사하고 길이를 돌려준다.
+// length 보다 긴 레코드는 잘라서 복사하고 레코드 전체를 반납한다.
+//
+uint32_t qrecordRead(qrecord_t *p_node, uint8_t *p_data, uint32_t length)
+{
+  uint8_t *p_buf;
+  uint32_t rec_len;
+
+
+  if (qrecordIsEmpty(p_node))
+  {
+    return 0;
+  }
+
+  rec_len = qrecordPeek(p_node, &p_buf);
+  rec_len = cmin(rec_len, length);
+  memcpy(p_data, p_buf, rec_len);
+  qrecordRelease(p_node);
+
+  return rec_len;
+}
+
+bool qrecordIsEmpty(qrecord_t *p_node)
+{
+  uint8_t *p_buf;
+
+  if (qbufferAvailable(&p_node->qbuffer) == 0)
+  {
+    return true;
+  }
+
+  // 남은 것이 WRAP 구간뿐일 수 있으므로 실제 레코드를 확인한다.
+  //
+  qrecordPeek(p_node, &p_buf);
+
+  return qbufferAvailable(&p_node->qbuffer) == 0 ? true : false;
+}
+
+// 지금 한 번에 기록할 수 있는 가장 긴 레코드의 데이터 길이
+//
+uint32_t qrecordAvailableForWrite(qrecord_t *p_node)
+{
+  qbuffer_t *p_q = &p_node->qbuffer;
+  uint32_t w_len;
+  uint32_t tail;
+  uint32_t ret;
+
+
+  w_len = qbufferAvailableForWrite(p_q);
+  tail  = p_q->len - p_q->in;
+
+  ret = cmax(cmin(w_len, tail), (w_len > tail) ? (w_len - tail) : 0);
+  if (ret <= QRECORD_HEADER_SIZE)
+  {
+    return 0;
+  }
+
+  return cmin(ret - QRECORD_HEADER_SIZE, QRECORD_LENGTH_MAX);
+}
+
+void qrecordFlush(qrecord_t *p_node)
+{
+  qbufferFlush(&p_node->qbuffer);
+}
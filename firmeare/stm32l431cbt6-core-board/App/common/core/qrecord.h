@@ -0,0 +1,50 @@
+#ifndef QRECORD_H_
+#define QRECORD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "qbuffer.h"
+
+
+
+// qbuffer 저장소 위에 만든 가변 길이 레코드 큐
+//
+// - 레코드는 [길이 2바이트][데이터] 로 저장되며 항상 연속된 영역에 놓인다.
+// - 버퍼 끝에 자리가 모자라면 QRECORD_WRAP 마커를 남기고 처음부터 기록한다.
+// - qbuffer 와 같이 생산자 하나, 소비자 하나에서 잠금 없이 사용할 수 있다.
+//
+#define QRECORD_HEADER_SIZE     2
+#define QRECORD_WRAP            0xFFFF
+#define QRECORD_LENGTH_MAX      0xFFFE
+
+
+typedef struct
+{
+  qbuffer_t qbuffer;
+
+  uint32_t  reserve_skip;     // Reserve 시 건너뛴 버퍼 끝 구간
+  uint32_t  reserve_len;      // Reserve 한 데이터 길이
+} qrecord_t;
+
+
+bool     qrecordCreate(qrecord_t *p_node, uint8_t *p_buf, uint32_t length);
+uint8_t *qrecordReserve(qrecord_t *p_node, uint32_t length);
+bool     qrecordCommit(qrecord_t *p_node, uint32_t length);
+bool     qrecordWrite(qrecord_t *p_node, uint8_t *p_data, uint32_t length);
+uint32_t qrecordPeek(qrecord_t *p_node, uint8_t **p_data);
+void     qrecordRelease(qrecord_t *p_node);
+uint32_t qrecordRead(qrecord_t *p_node, uint8_t *p_data, uint32_t length);
+bool     qrecordIsEmpty(qrecord_t *p_node);
+uint32_t qrecordAvailableForWrite(qrecord_t *p_node);
+void     qrecordFlush(qrecord_t *p_node);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,157 @@
+#include "slip.h"
+#include "util.h"
+
+
+
+
+static uint32_t slipEncodeRaw(uint8_t data, uint8_t *p_out);
+
+
+
+uint32_t slipEncodeRaw(uint8_t data, uint8_t *p_out)
+{
+  if (data == SLIP_END)
+  {
+    p_out[0] = SLIP_ESC;
+    p_out[1] = SLIP_ESC_END;
+    return 2;
+  }
+  if (data == SLIP_ESC)
+  {
+    p_out[0] = SLIP_ESC;
+    p_out[1] = SLIP_ESC_ESC;
+    return 2;
+  }
+
+  p_out[0] = data;
+  return 1;
+}
+
+// 앞의 END 는 선로 잡음으로 쌓인 바이트를 끊어 수신측이 바로 동기를 잡게 한다.
+//
+uint32_t slipEncodeBegin(slip_enc_t *p_enc, uint8_t *p_out)
+{
+  p_enc->crc = SLIP_CRC_INIT;
+
+  p_out[0] = SLIP_END;
+  return 1;
+}
+
+uint32_t slipEncodeByte(slip_enc_t *p_enc, uint8_t data, uint8_t *p_out)
+{
+  utilUpdateCrc(&p_enc->crc, data);
+
+  return slipEncodeRaw(data, p_out);
+}
+
+uint32_t slipEncodeEnd(slip_enc_t *p_enc, uint8_t *p_out)
+{
+  uint32_t len = 0;
+  uint16_t crc;
+
+
+  crc  = p_enc->crc;
+  len += slipEncodeRaw(crc >> 8, &p_out[len]);
+  len += slipEncodeRaw(crc >> 0, &p_out[len]);
+  p_out[len++] = SLIP_END;
+
+  return len;
+}
+
+void slipDecodeInit(slip_dec_t *p_dec, uint8_t *p_buf, uint32_t length)
+{
+  p_dec->p_buf     = p_buf;
+  p_dec->buf_len   = length;
+  p_dec->length    = 0;
+
+  p_dec->frame_cnt = 0;
+  p_dec->crc_err   = 0;
+  p_dec->len_err   = 0;
+  p_dec->esc_err   = 0;
+
+  slipDecodeReset(p_dec);
+}
+
+void slipDecodeReset(slip_dec_t *p_dec)
+{
+  p_dec->index   = 0;
+  p_dec->crc     = SLIP_CRC_INIT;
+  p_dec->is_esc  = false;
+  p_dec->is_drop = false;
+}
+
+// 프레임이 완성되면 true, 데이터는 p_buf 의 앞 length 바이트
+// 다음 호출에서 새 프레임을 받으므로 그 전에 처리한다.
+//
+bool slipDecodeByte(slip_dec_t *p_dec, uint8_t data)
+{
+  bool ret = false;
+
+
+  if (data == SLIP_END)
+  {
+    // 빈 프레임(연속된 END)은 무시한다.
+    //
+    if (p_dec->is_drop != true && p_dec->index > 0)
+    {
+      if (p_dec->index <= SLIP_CRC_SIZE)
+      {
+        p_dec->len_err++;
+      }
+      else if (p_dec->crc != 0)
+      {
+        p_dec->crc_err++;
+      }
+      else
+      {
+        p_dec->length = p_dec->index - SLIP_CRC_SIZE;
+        p_dec->frame_cnt++;
+        ret = true;
+      }
+    }
+    slipDecodeReset(p_dec);
+    return ret;
+  }
+
+  if (p_dec->is_drop == true)
+  {
+    return false;
+  }
+
+  if (p_dec->is_esc == true)
+  {
+    p_dec->is_esc = false;
+
+    if (data == SLIP_ESC_END)
+    {
+      data = SLIP_END;
+    }
+    else if (data == SLIP_ESC_ESC)
+    {
+      data = SLIP_ESC;
+    }
+    else
+    {
+      p_dec->esc_err++;
+      p_dec->is_drop = true;
+      return false;
+    }
+  }
+  else if (data == SLIP_ESC)
+  {
+    p_dec->is_esc = true;
+    return false;
+  }
+
+  if (p_dec->index >= p_dec->buf_len)
+  {
+    p_dec->len_err++;
+    p_dec->is_drop = true;
+    return false;
+  }
+
+  p_dec->p_buf[p_dec->index++] = data;
+  utilUpdateCrc(&p_dec->crc, data);
+
+  return false;
+}
@@ -0,0 +1,69 @@
+#ifndef SLIP_H_
+#define SLIP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+
+// SLIP(RFC 1055) 프레임 + CRC16
+//
+// - 프레임은 [END][데이터][CRC16 상위, 하위][END] 이며 데이터와 CRC 의 END/ESC 는 ESC 로 바꿔 보낸다.
+// - CRC 는 utilUpdateCrc() (초기값 0xFFFF), 상위 바이트 먼저 보내므로 CRC 까지 계산하면 0 이 된다.
+// - 앞뒤 바이트를 볼 필요가 없어 한 바이트씩 인코딩/디코딩할 수 있다.
+// - HAL 에 의존하지 않으므로 PC 쪽에서도 util.c 와 같이 빌드해서 쓴다.
+//
+#define SLIP_END                0xC0
+#define SLIP_ESC                0xDB
+#define SLIP_ESC_END            0xDC
+#define SLIP_ESC_ESC            0xDD
+
+#define SLIP_CRC_INIT           0xFFFF
+#define SLIP_CRC_SIZE           2
+#define SLIP_ENCODE_BYTE_MAX    2                             // 데이터 한 바이트의 최대 인코딩 길이
+#define SLIP_ENCODE_END_MAX     (SLIP_CRC_SIZE * 2 + 1)       // slipEncodeEnd() 최대 길이
+
+
+typedef struct
+{
+  uint16_t crc;
+} slip_enc_t;
+
+typedef struct
+{
+  uint8_t  *p_buf;
+  uint32_t  buf_len;
+  uint32_t  index;
+  uint16_t  crc;
+  bool      is_esc;
+  bool      is_drop;      // 버퍼 초과나 잘못된 ESC, 다음 END 까지 버린다
+
+  uint32_t  length;       // 완료된 프레임의 데이터 길이 (CRC 제외)
+
+  uint32_t  frame_cnt;
+  uint32_t  crc_err;
+  uint32_t  len_err;
+  uint32_t  esc_err;
+} slip_dec_t;
+
+
+uint32_t slipEncodeBegin(slip_enc_t *p_enc, uint8_t *p_out);
+uint32_t slipEncodeByte(slip_enc_t *p_enc, uint8_t data, uint8_t *p_out);
+uint32_t slipEncodeEnd(slip_enc_t *p_enc, uint8_t *p_out);
+
+void     slipDecodeInit(slip_dec_t *p_dec, uint8_t *p_buf, uint32_t length);
+void     slipDecodeReset(slip_dec_t *p_dec);
+bool     slipDecodeByte(slip_dec_t *p_dec, uint8_t data);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -14,6 +14,7 @@ uint32_t utilConvert8ToU32 (uint8_t *p_data);
 uint16_t utilConvert8ToU16 (uint8_t *p_data);
 
 void utilUpdateCrc(uint16_t *p_crc_cur, uint8_t data_in);
+void utilUpdateCrcModbus(uint16_t *p_crc_cur, uint8_t data_in);
 int hex2int(char c);
 #ifdef __cplusplus
 }
@@ -36,6 +36,9 @@ typedef struct
 bool cliInit(void);
 bool cliOpen(uint8_t ch, uint32_t baud);
 bool cliIsBusy(void);
+bool cliSetLineMode(bool enable);
+bool cliIsLineMode(void);
+bool cliIsIdle(void);
 bool cliOpenLog(uint8_t ch, uint32_t baud);
 bool cliMain(void);
 void cliPrintf(const char *fmt, ...);
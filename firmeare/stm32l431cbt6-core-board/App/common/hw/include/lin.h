@@ -0,0 +1,60 @@
+#ifndef LIN_H_
+#define LIN_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "hw_def.h"
+
+#ifdef _USE_HW_LIN
+
+
+#define LIN_SLOT_MAX            HW_LIN_SLOT_MAX
+#define LIN_DATA_MAX            8
+
+#define LIN_DIR_TX              0     // 마스터가 응답(데이터)을 보낸다
+#define LIN_DIR_RX              1     // 슬레이브가 응답한다
+
+#define LIN_CHECKSUM_CLASSIC    0     // 데이터만
+#define LIN_CHECKSUM_ENHANCED   1     // PID + 데이터 (진단 프레임 0x3C/0x3D 는 항상 classic)
+
+#define LIN_STATUS_NONE         0
+#define LIN_STATUS_OK           1
+#define LIN_STATUS_TIMEOUT      2     // 응답 없음
+#define LIN_STATUS_SHORT        3     // 응답이 일부만 옴
+#define LIN_STATUS_CHECKSUM     4
+#define LIN_STATUS_BIT_ERR      5     // 보낸 데이터와 에코가 다름
+#define LIN_STATUS_NO_BREAK     6     // 보낸 브레이크가 검출되지 않음 (버스 이상)
+
+
+typedef struct
+{
+  uint8_t  id;          // 0 ~ 0x3F
+  uint8_t  dir;         // LIN_DIR_xx
+  uint8_t  length;      // 1 ~ 8
+  uint8_t  checksum;    // LIN_CHECKSUM_xx
+  uint16_t slot_ms;     // 슬롯 시간, 다음 헤더까지
+  uint8_t *p_data;      // TX 면 보낼 데이터, RX 면 받은 데이터 (ISR 에서 갱신)
+} lin_slot_t;
+
+
+bool    linInit(void);
+bool    linOpen(uint8_t ch, uint32_t baud);
+bool    linSetSchedule(const lin_slot_t *p_slot, uint8_t count);
+bool    linStart(void);
+void    linStop(void);
+bool    linIsRunning(void);
+uint8_t linGetStatus(uint8_t slot);
+void    linSetCallback(void (*p_func)(uint8_t slot, uint8_t status));
+uint8_t linMakePid(uint8_t id);
+uint8_t linCalcChecksum(uint8_t pid, const uint8_t *p_data, uint8_t length, uint8_t type);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
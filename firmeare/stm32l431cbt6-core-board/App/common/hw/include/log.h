@@ -14,6 +14,107 @@ extern "C" {
 #define LOG_CH            HW_LOG_CH
 #define LOG_BOOT_BUF_MAX  HW_LOG_BOOT_BUF_MAX
 #define LOG_LIST_BUF_MAX  HW_LOG_LIST_BUF_MAX
+#define LOG_BOOT_LINE_MAX HW_LOG_BOOT_LINE_MAX
+#define LOG_LIST_LINE_MAX HW_LOG_LIST_LINE_MAX
+#define LOG_RING_BUF_MAX  HW_LOG_RING_BUF_MAX
+#define LOG_LINE_MAX      HW_LOG_LINE_MAX
+
+#define LOG_LEVEL_ERROR   0
+#define LOG_LEVEL_WARN    1
+#define LOG_LEVEL_INFO    2
+#define LOG_LEVEL_DEBUG   3
+#define LOG_LEVEL_TRACE   4
+
+#define LOG_TOKEN_ARGS_MAX  8
+
+
+// 토큰 로그 (_USE_HW_LOG_TOKEN)
+//
+// - 형식 문자열은 로드하지 않는 .log_fmt 섹션에만 두고, 섹션 안의 주소(16비트)를 토큰으로 보낸다.
+// - 인자는 변환 없이 32비트 값으로 보내며 정수 형식(%d %u %x %c)만 쓸 수 있다. (%s, %f 불가)
+// - UART 에는 SLIP 프레임(slip.h, CRC16 포함)으로 나가고 일반 텍스트 로그와 섞여도 END(0xC0)로 구분된다.
+//   프레임 데이터 : [0x01][토큰 u16][시간 us u64][레벨 u8][인자 u32 x n] (리틀 엔디안)
+// - PC 에서는 tools/log_decode.py 가 ELF 의 .log_fmt 섹션에서 토큰 위치의 문자열을 찾아 인자를 넣어 출력한다.
+// - 정의하지 않으면 logPrintf() 로 바뀌어 기기에서 문자열을 만든다.
+//
+#define LOG_TOKEN_FRAME_TYPE  0x01
+
+#ifdef _USE_HW_LOG_TOKEN
+#define logTokenLevel(level, fmt, ...)                                                              \
+  do {                                                                                              \
+    static const char log_fmt_str[] __attribute__((section(".log_fmt"), used)) = fmt;               \
+    const uint32_t log_args[] = { 0, ##__VA_ARGS__ };                                               \
+    _Static_assert(sizeof(log_args)/4 - 1 <= LOG_TOKEN_ARGS_MAX, "too many log arguments");         \
+    logTokenWrite(level, (uint32_t)(uintptr_t)log_fmt_str, &log_args[1], sizeof(log_args)/4 - 1);   \
+  } while(0)
+#else
+#define logTokenLevel(level, fmt, ...)  logPrintfLevel(level, fmt, ##__VA_ARGS__)
+#endif
+
+#define logToken(fmt, ...)    logTokenLevel(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+
+// 레벨 로그
+//
+// - LOG_E/W/I/D/T(모듈, fmt, ...) 는 모듈의 컴파일 레벨(HW_LOG_LEVEL_<모듈>, 없으면 HW_LOG_LEVEL)보다
+//   높으면 조건이 상수 false 가 되어 인자 계산까지 코드에서 빠진다.
+// - 컴파일된 레벨은 다시 모듈별 실행 레벨(log_mod_level[], CLI "log level")로 거른다.
+//
+enum
+{
+  LOG_MOD_HW,
+  LOG_MOD_UART,
+  LOG_MOD_LIN,
+  LOG_MOD_MODBUS,
+  LOG_MOD_PACKET,
+  LOG_MOD_CLI,
+  LOG_MOD_AP,
+  LOG_MOD_MAX
+};
+
+#ifdef HW_LOG_LEVEL_HW
+#define LOG_CT_LEVEL_HW        HW_LOG_LEVEL_HW
+#else
+#define LOG_CT_LEVEL_HW        HW_LOG_LEVEL
+#endif
+#ifdef HW_LOG_LEVEL_UART
+#define LOG_CT_LEVEL_UART      HW_LOG_LEVEL_UART
+#else
+#define LOG_CT_LEVEL_UART      HW_LOG_LEVEL
+#endif
+#ifdef HW_LOG_LEVEL_LIN
+#define LOG_CT_LEVEL_LIN       HW_LOG_LEVEL_LIN
+#else
+#define LOG_CT_LEVEL_LIN       HW_LOG_LEVEL
+#endif
+#ifdef HW_LOG_LEVEL_MODBUS
+#define LOG_CT_LEVEL_MODBUS    HW_LOG_LEVEL_MODBUS
+#else
+#define LOG_CT_LEVEL_MODBUS    HW_LOG_LEVEL
+#endif
+#ifdef HW_LOG_LEVEL_PACKET
+#define LOG_CT_LEVEL_PACKET    HW_LOG_LEVEL_PACKET
+#else
+#define LOG_CT_LEVEL_PACKET    HW_LOG_LEVEL
+#endif
+#ifdef HW_LOG_LEVEL_CLI
+#define LOG_CT_LEVEL_CLI       HW_LOG_LEVEL_CLI
+#else
+#define LOG_CT_LEVEL_CLI       HW_LOG_LEVEL
+#endif
+#ifdef HW_LOG_LEVEL_AP
+#define LOG_CT_LEVEL_AP        HW_LOG_LEVEL_AP
+#else
+#define LOG_CT_LEVEL_AP        HW_LOG_LEVEL
+#endif
+
+#define LOG_AT(mod, level, fmt, ...)                                                                \
+  do {                                                                                              \
+    if ((level) <= LOG_CT_LEVEL_##mod && (level) <= log_mod_level[LOG_MOD_##mod])                   \
+      logPrintfLevel(level, fmt, ##__VA_ARGS__);                                                    \
+  } while(0)
+
+
+extern volatile uint8_t log_mod_level[LOG_MOD_MAX];
 
 
 bool logInit(void);
@@ -22,9 +123,28 @@ void logDisable(void);
 bool logOpen(uint8_t ch, uint32_t baud);
 void logBoot(uint8_t enable);
 void logPrintf(const char *fmt, ...);
+void logPrintfLevel(uint8_t level, const char *fmt, ...);
+void logVPrintf(uint8_t level, const char *fmt, va_list args);
+void logTokenWrite(uint8_t level, uint32_t token, const uint32_t *p_args, uint32_t count);
+void logUpdate(void);
+void logFlush(void);
+uint32_t logGetDropCount(void);
+bool logSetModuleLevel(uint8_t mod, uint8_t level);
+
+#else
+
+// 로그를 쓰지 않으면 레벨 로그는 인자까지 모두 빠진다.
+//
+#define LOG_AT(mod, level, fmt, ...)  do { } while(0)
 
 #endif
 
+#define LOG_E(mod, fmt, ...)  LOG_AT(mod, LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_W(mod, fmt, ...)  LOG_AT(mod, LOG_LEVEL_WARN,  fmt, ##__VA_ARGS__)
+#define LOG_I(mod, fmt, ...)  LOG_AT(mod, LOG_LEVEL_INFO,  fmt, ##__VA_ARGS__)
+#define LOG_D(mod, fmt, ...)  LOG_AT(mod, LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_T(mod, fmt, ...)  LOG_AT(mod, LOG_LEVEL_TRACE, fmt, ##__VA_ARGS__)
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,47 @@
+#ifndef MODBUS_H_
+#define MODBUS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "hw_def.h"
+
+#ifdef _USE_HW_MODBUS
+
+
+#define MODBUS_FRAME_MAX              256
+
+#define MODBUS_REG_HOLDING            0
+#define MODBUS_REG_INPUT              1
+
+#define MODBUS_EX_NONE                0x00
+#define MODBUS_EX_ILLEGAL_FUNCTION    0x01
+#define MODBUS_EX_ILLEGAL_ADDRESS     0x02
+#define MODBUS_EX_ILLEGAL_VALUE       0x03
+#define MODBUS_EX_DEVICE_FAILURE      0x04
+
+
+// 레지스터 맵 콜백, 수신 타임아웃 인터럽트에서 호출되므로 짧게 처리한다.
+// 리턴은 MODBUS_EX_xx
+//
+typedef struct
+{
+  uint8_t (*read)(uint8_t type, uint16_t addr, uint16_t count, uint16_t *p_data);
+  uint8_t (*write)(uint16_t addr, uint16_t count, const uint16_t *p_data);
+} modbus_map_t;
+
+
+bool     modbusInit(void);
+bool     modbusOpen(uint8_t ch, uint32_t baud, uint8_t id);
+void     modbusSetMap(const modbus_map_t *p_map);
+uint32_t modbusProcessFrame(const uint8_t *p_req, uint32_t req_len, uint8_t *p_resp);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
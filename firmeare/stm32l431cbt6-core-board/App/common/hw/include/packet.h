@@ -0,0 +1,36 @@
+#ifndef PACKET_H_
+#define PACKET_H_
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hw_def.h"
+
+
+#ifdef _USE_HW_PACKET
+
+#define PACKET_MAX_CH     HW_PACKET_MAX_CH
+#define PACKET_DATA_MAX   HW_PACKET_DATA_MAX
+
+
+bool     packetInit(void);
+bool     packetOpen(uint8_t ch, uint8_t uart_ch, uint32_t baud);
+bool     packetIsOpen(uint8_t ch);
+bool     packetBegin(uint8_t ch);
+bool     packetWriteData(uint8_t ch, const uint8_t *p_data, uint32_t length);
+bool     packetEnd(uint8_t ch);
+bool     packetSend(uint8_t ch, const uint8_t *p_data, uint32_t length);
+bool     packetReceive(uint8_t ch);
+uint32_t packetGetData(uint8_t ch, uint8_t **p_data);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+
+
+#endif
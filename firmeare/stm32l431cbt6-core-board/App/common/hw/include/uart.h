@@ -11,6 +11,29 @@ extern "C" {
 
 #define UART_MAX_CH         HW_UART_MAX_CH
 
+#define UART_RX_EVENT_DATA  (1<<0)    // DMA HT/TC
+#define UART_RX_EVENT_IDLE  (1<<1)    // 수신 후 IDLE 라인 (burst 끝)
+#define UART_RX_EVENT_OVERRUN (1<<2)  // DMA 가 읽지 않은 데이터를 덮어씀
+#define UART_RX_EVENT_MATCH (1<<3)    // uartSetMatchChar() 문자 수신
+
+#define UART_BAUD_AUTO      0xFFFFFFFF  // uartOpen() 속도 대신 넘기면 호스트 속도를 자동 검출
+
+#define UART_RX_OVR_NEWEST  0         // 추월 시 최신 데이터만 남긴다
+#define UART_RX_OVR_ERROR   1         // 추월 시 쌓인 데이터를 모두 버리고 이벤트로 알린다
+
+
+typedef struct
+{
+  uint32_t rx_overrun;    // 순환 DMA 추월 횟수
+  uint32_t ore;
+  uint32_t fe;
+  uint32_t ne;
+  uint32_t pe;
+  uint32_t restart;       // 에러로 DMA 수신을 다시 시작한 횟수
+  uint32_t abr;           // 자동 속도 검출 실패 횟수
+} uart_err_t;
+
+
 bool     uartInit(void);
 bool     uartDeInit(void);
 bool     uartIsInit(void);
@@ -18,11 +41,33 @@ bool     uartOpen(uint8_t ch, uint32_t baud);
 bool     uartIsOpen(uint8_t ch);
 bool     uartClose(uint8_t ch);
 uint32_t uartAvailable(uint8_t ch);
+uint32_t uartWaitAvailable(uint8_t ch, uint32_t timeout);
+uint8_t  uartGetRxEvent(uint8_t ch);
+bool     uartSetRxOverrunPolicy(uint8_t ch, uint8_t policy);
+bool     uartGetErr(uint8_t ch, uart_err_t *p_err);
+bool     uartSetRxCallback(uint8_t ch, void (*p_func)(uint8_t ch, uint8_t event));
 bool     uartFlush(uint8_t ch);
+bool     uartFlushTx(uint8_t ch);
 uint8_t  uartRead(uint8_t ch);
+uint32_t uartReadBuf(uint8_t ch, uint8_t *p_data, uint32_t length);
+uint32_t uartPeekRx(uint8_t ch, uint8_t **p_data);
+void     uartConsumeRx(uint8_t ch, uint32_t length);
+uint32_t uartAvailableForWrite(uint8_t ch);
 uint32_t uartWrite(uint8_t ch, uint8_t *p_data, uint32_t length);
 uint32_t uartPrintf(uint8_t ch, const char *fmt, ...);
 uint32_t uartGetBaud(uint8_t ch);
+uint32_t uartGetBaudReal(uint8_t ch);
+int32_t  uartGetBaudErr(uint8_t ch);      // 0.01% 단위
+bool     uartIsBaudLocked(uint8_t ch);
+bool     uartLinSendBreak(uint8_t ch);
+bool     uartLinSetBreakCallback(uint8_t ch, void (*p_func)(uint8_t ch));
+bool     uartSetRxTimeout(uint8_t ch, uint32_t bits, void (*p_func)(uint8_t ch));
+bool     uartSetMatchChar(uint8_t ch, uint8_t c, void (*p_func)(uint8_t ch));
+bool     uartSetOwner(uint8_t ch, const char *p_owner);
+const char *uartGetOwner(uint8_t ch);
+void     uartIRQHandler(UART_HandleTypeDef *huart);
+bool     uartSetDeTime(uint8_t ch, uint8_t assert_time, uint8_t deassert_time);   // 1/16 비트 단위
+bool     uartGetTurnaround(uint8_t ch, uint32_t *p_min_us, uint32_t *p_last_us);
 uint32_t uartGetRxCnt(uint8_t ch);
 uint32_t uartGetTxCnt(uint8_t ch);
 
@@ -68,6 +68,9 @@ typedef struct
   uint8_t  log_ch;
   uint32_t log_baud;
   uint8_t  state;
+  bool     is_line_mode;
+  volatile uint32_t line_rdy;   // CR 수신 횟수 (CMF 인터럽트)
+  uint32_t line_done;
   char     print_buffer[CLI_PRINT_BUF_MAX];
   uint16_t  argc;
   char     *argv[CLI_ARGS_MAX];
@@ -91,6 +94,7 @@ cli_t   cli_node;
 
 
 static bool cliUpdate(cli_t *p_cli, uint8_t rx_data);
+static uint32_t cliReadRx(cli_t *p_cli, uint8_t *p_data, uint32_t length);
 static void cliLineClean(cli_t *p_cli);
 static void cliLineAdd(cli_t *p_cli);
 static void cliLineChange(cli_t *p_cli, int8_t key_up);
@@ -103,10 +107,12 @@ static int32_t  cliArgsGetData(uint8_t index);
 static float    cliArgsGetFloat(uint8_t index);
 static char    *cliArgsGetStr(uint8_t index);
 static bool     cliArgsIsStr(uint8_t index, const char *p_str);
+static void     cliLineMatchISR(uint8_t ch);
 
 
 void cliShowList(cli_args_t *args);
 void cliMemoryDump(cli_args_t *args);
+void cliCmd(cli_args_t *args);
 
 
 bool cliInit(void)
@@ -115,6 +121,9 @@ bool cliInit(void)
   cli_node.is_log  = false;
   cli_node.is_busy = false;
   cli_node.state   = CLI_RX_IDLE;
+  cli_node.is_line_mode = false;
+  cli_node.line_rdy     = 0;
+  cli_node.line_done    = 0;
 
   cli_node.hist_line_i     = 0;
   cli_node.hist_line_last  = 0;
@@ -131,6 +140,7 @@ bool cliInit(void)
 
   cliAdd("help", cliShowList);
   cliAdd("md"  , cliMemoryDump);
+  cliAdd("cli" , cliCmd);
 
   return true;
 }
@@ -140,18 +150,76 @@ bool cliOpen(uint8_t ch, uint32_t baud)
   cli_node.ch = ch;
 
 
-  if (cli_node.is_open == false || cli_node.baud != baud)
+  // 자동 속도 검출은 같은 요청이라도 다시 시작한다.
+  // 실패하면 포트는 이전 속도 그대로 열려 있다.
+  //
+  if (cli_node.is_open == false || cli_node.baud != baud || baud == UART_BAUD_AUTO)
   {
     if (baud > 0)
     {
-      cli_node.baud = baud;
-      cli_node.is_open = uartOpen(ch, baud);
+      if (uartOpen(ch, baud) == true)
+      {
+        cli_node.baud = baud;
+      }
+      cli_node.is_open = uartIsOpen(ch);
     }
   }
 
+  if (cli_node.is_open == true && cli_node.is_line_mode == true)
+  {
+    uartSetMatchChar(ch, CLI_KEY_ENTER, cliLineMatchISR);
+  }
+
   return cli_node.is_open;
 }
 
+// 라인 모드에서는 CR 이 들어왔을 때만 수신 데이터를 처리한다.
+// 한 줄이 다 들어올 때까지 메인 루프는 CLI 를 건너뛰고, 입력 에코도 줄 단위로 나간다.
+// (스크립트나 호스트 프로그램이 명령을 보낼 때 사용)
+//
+bool cliSetLineMode(bool enable)
+{
+  cli_node.line_done    = cli_node.line_rdy;
+  cli_node.is_line_mode = enable;
+
+  if (cli_node.is_open != true)
+  {
+    return true;
+  }
+
+  // CR 매치를 걸지 못하면 줄이 들어와도 알 수 없으므로 바이트 단위로 되돌린다.
+  //
+  if (uartSetMatchChar(cli_node.ch, CLI_KEY_ENTER, enable ? cliLineMatchISR:NULL) != true)
+  {
+    cli_node.is_line_mode = false;
+    return false;
+  }
+
+  return true;
+}
+
+bool cliIsLineMode(void)
+{
+  return cli_node.is_line_mode;
+}
+
+// 라인 모드에서 처리할 줄이 없으면 true. 메인 루프는 이때 __WFI() 로 다음 인터럽트를 기다린다.
+//
+bool cliIsIdle(void)
+{
+  if (cli_node.is_open != true || cli_node.is_line_mode != true)
+  {
+    return false;
+  }
+
+  return cli_node.line_rdy == cli_node.line_done;
+}
+
+void cliLineMatchISR(uint8_t ch)
+{
+  cli_node.line_rdy++;
+}
+
 bool cliIsBusy(void)
 {
   return cli_node.is_busy;
@@ -212,19 +280,74 @@ void cliShowPrompt(cli_t *p_cli)
 
 bool cliMain(void)
 {
+  uint8_t  rx_buf[32];
+  uint32_t rx_len;
+
+
   if (cli_node.is_open != true)
   {
     return false;
   }
 
-  if (uartAvailable(cli_node.ch) > 0)
+  if (cli_node.is_line_mode == true)
   {
-    cliUpdate(&cli_node, uartRead(cli_node.ch));
+    uint32_t line_rdy;
+
+    line_rdy = cli_node.line_rdy;
+    if (line_rdy == cli_node.line_done)
+    {
+      return true;
+    }
+    cli_node.line_done = line_rdy;
+
+    // 받은 줄을 모두 처리한다. 처리 중에 새로 들어온 줄은 line_rdy 가 다시 알려준다.
+    //
+    while((rx_len = cliReadRx(&cli_node, rx_buf, sizeof(rx_buf))) > 0)
+    {
+      for (uint32_t i=0; i<rx_len; i++)
+      {
+        cliUpdate(&cli_node, rx_buf[i]);
+      }
+    }
+    return true;
+  }
+
+  // 명령 실행 중에 다시 uart 를 읽을 수 있으므로 복사한 뒤 처리한다.
+  //
+  rx_len = cliReadRx(&cli_node, rx_buf, sizeof(rx_buf));
+  for (uint32_t i=0; i<rx_len; i++)
+  {
+    cliUpdate(&cli_node, rx_buf[i]);
   }
 
   return true;
 }
 
+// 줄 끝(CR/LF)까지만 꺼내 온다. Enter 뒤의 바이트는 실행될 명령이 읽도록
+// ('q' 중단 등) 수신 버퍼에 남겨 둔다.
+//
+uint32_t cliReadRx(cli_t *p_cli, uint8_t *p_data, uint32_t length)
+{
+  uint8_t *p_rx;
+  uint32_t rx_len;
+
+
+  rx_len = uartPeekRx(p_cli->ch, &p_rx);
+  rx_len = cmin(rx_len, length);
+  for (uint32_t i=0; i<rx_len; i++)
+  {
+    p_data[i] = p_rx[i];
+    if (p_rx[i] == CLI_KEY_ENTER || p_rx[i] == '\n')
+    {
+      rx_len = i + 1;
+      break;
+    }
+  }
+  uartConsumeRx(p_cli->ch, rx_len);
+
+  return rx_len;
+}
+
 uint32_t cliAvailable(void)
 {
   return uartAvailable(cli_node.ch);
@@ -845,3 +968,39 @@ void cliMoveDown(uint8_t y)
 }
 
 #endif
+
+void cliCmd(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "line") == true)
+  {
+    cliPrintf("line mode : %s\n", cliIsLineMode() ? "on":"off");
+    ret = true;
+  }
+
+  if (args->argc == 2 && args->isStr(0, "line") == true)
+  {
+    if (args->isStr(1, "on") == true || args->isStr(1, "off") == true)
+    {
+      bool enable = args->isStr(1, "on");
+
+      if (cliSetLineMode(enable) == true)
+      {
+        cliPrintf("line mode : %s\n", enable ? "on":"off");
+      }
+      else
+      {
+        cliPrintf("line mode : fail\n");
+      }
+      ret = true;
+    }
+  }
+
+  if (ret != true)
+  {
+    cliPrintf("cli line\n");
+    cliPrintf("cli line on|off\n");
+  }
+}
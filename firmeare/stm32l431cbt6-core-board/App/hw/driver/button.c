@@ -2,6 +2,7 @@
 #include "button.h"
 #include "cli.h"
 #include "swtimer.h"
+#include "log.h"
 
 
 #ifdef _USE_HW_BUTTON
@@ -87,7 +88,7 @@ bool buttonInit(void)
   }
   else
   {
-    logPrintf("[NG] buttonInit()\n     swtimerGetHandle()\n");
+    LOG_E(HW, "[NG] buttonInit()\n     swtimerGetHandle()\n");
   }
 
 #ifdef _USE_HW_CLI
@@ -0,0 +1,491 @@
+#include "lin.h"
+#include "uart.h"
+#include "cli.h"
+
+
+#ifdef _USE_HW_LIN
+
+
+#define LIN_SYNC                0x55
+#define LIN_HEADER_BITS         34      // 브레이크(13) + 델리미터(1) + 싱크(10) + PID(10)
+#define LIN_IDLE_BITS           11      // 응답 뒤 IDLE 이벤트가 올 때까지
+#define LIN_SLOT_GAP_MIN_US     100
+
+#define LIN_STATE_HEADER        0       // 다음 타이머에서 헤더를 보낸다
+#define LIN_STATE_RESPONSE      1       // 다음 타이머에서 응답을 확인한다
+
+
+typedef struct
+{
+  uint8_t  status;
+  uint32_t ok_cnt;
+  uint32_t err_cnt;
+} lin_stat_t;
+
+typedef struct
+{
+  bool     is_open;
+  bool     is_run;
+  uint8_t  ch;
+  uint32_t baud;
+
+  const lin_slot_t *p_sched;
+  uint8_t           count;
+  const lin_slot_t *p_sched_next;   // 슬롯 경계에서 바꿀 스케줄
+  uint8_t           count_next;
+  volatile bool     sched_req;
+
+  uint8_t  idx;
+  uint8_t  state;
+  uint32_t wait_us;                 // 상태 전환까지 남은 시간
+  uint32_t period_us;               // 현재 타이머 주기
+  uint32_t frame_us;                // 현재 프레임의 최대 시간
+
+  volatile bool     break_det;
+  volatile uint32_t break_cnt;
+
+  uint8_t  tx_buf[2 + LIN_DATA_MAX + 1];
+  uint8_t  tx_len;
+
+  void (*func)(uint8_t slot, uint8_t status);
+} lin_t;
+
+
+#ifdef _USE_HW_CLI
+static void cliLin(cli_args_t *args);
+#endif
+static void linTimerSet(uint32_t us);
+static void linTimerISR(void);
+static void linBreakISR(uint8_t ch);
+static void linSendHeader(void);
+static void linCheckResponse(void);
+
+
+static lin_t lin;
+static lin_stat_t lin_stat[LIN_SLOT_MAX];
+
+// TIM6 인터럽트는 우선순위 0, USART/DMA 인터럽트는 1 이라 슬롯 시각이 UART 처리에 밀리지 않는다.
+// 남는 지터는 인터럽트를 막는 짧은 구간(uartTxStart(), log 기록 등)뿐이다.
+//
+extern TIM_HandleTypeDef htim6;     // 1MHz 카운트
+
+#ifdef _USE_HW_CLI
+static uint8_t lin_demo_tx[3] = {0x11, 0x22, 0x33};
+static uint8_t lin_demo_rx[8];
+static const lin_slot_t lin_demo_sched[] =
+{
+  {0x16, LIN_DIR_TX, 3, LIN_CHECKSUM_ENHANCED, 10, lin_demo_tx},
+  {0x17, LIN_DIR_RX, 8, LIN_CHECKSUM_ENHANCED, 10, lin_demo_rx},
+};
+#endif
+
+
+bool linInit(void)
+{
+  lin.is_open   = false;
+  lin.is_run    = false;
+  lin.ch        = HW_LIN_CH;
+  lin.baud      = 0;
+  lin.p_sched   = NULL;
+  lin.count     = 0;
+  lin.sched_req = false;
+  lin.state     = LIN_STATE_HEADER;
+  lin.break_det = false;
+  lin.break_cnt = 0;
+  lin.func      = NULL;
+
+  for (int i=0; i<LIN_SLOT_MAX; i++)
+  {
+    lin_stat[i].status  = LIN_STATUS_NONE;
+    lin_stat[i].ok_cnt  = 0;
+    lin_stat[i].err_cnt = 0;
+  }
+
+#ifdef _USE_HW_CLI
+  cliAdd("lin", cliLin);
+#endif
+
+  return true;
+}
+
+bool linOpen(uint8_t ch, uint32_t baud)
+{
+  if (lin.is_run == true) return false;
+
+  // 스케줄 인터럽트가 TX 링에 쓰고 응답을 읽으므로 채널을 차지한다.
+  //
+  if (uartSetOwner(ch, "lin") != true)
+  {
+    lin.is_open = false;
+    return false;
+  }
+
+  lin.ch   = ch;
+  lin.baud = baud;
+
+  lin.is_open = uartOpen(ch, baud);
+  if (lin.is_open == true)
+  {
+    lin.is_open = uartLinSetBreakCallback(ch, linBreakISR);
+  }
+  if (lin.is_open != true)
+  {
+    uartSetOwner(ch, NULL);
+  }
+
+  return lin.is_open;
+}
+
+// 실행 중이면 현재 슬롯이 끝난 뒤 바뀐다.
+//
+bool linSetSchedule(const lin_slot_t *p_slot, uint8_t count)
+{
+  if (count == 0 || count > LIN_SLOT_MAX) return false;
+
+  for (int i=0; i<count; i++)
+  {
+    if (p_slot[i].id > 0x3F || p_slot[i].length == 0 || p_slot[i].length > LIN_DATA_MAX)
+    {
+      return false;
+    }
+  }
+
+  if (lin.is_run == true)
+  {
+    lin.p_sched_next = p_slot;
+    lin.count_next   = count;
+    lin.sched_req    = true;
+  }
+  else
+  {
+    lin.p_sched = p_slot;
+    lin.count   = count;
+  }
+
+  for (int i=0; i<LIN_SLOT_MAX; i++)
+  {
+    lin_stat[i].status  = LIN_STATUS_NONE;
+    lin_stat[i].ok_cnt  = 0;
+    lin_stat[i].err_cnt = 0;
+  }
+
+  return true;
+}
+
+bool linStart(void)
+{
+  if (lin.is_open != true || lin.p_sched == NULL) return false;
+  if (lin.is_run == true) return true;
+
+  lin.idx    = 0;
+  lin.state  = LIN_STATE_HEADER;
+  lin.is_run = true;
+
+  HAL_TIM_Base_Stop_IT(&htim6);
+  __HAL_TIM_SET_COUNTER(&htim6, 0);
+  linTimerSet(LIN_SLOT_GAP_MIN_US);
+  __HAL_TIM_CLEAR_FLAG(&htim6, TIM_FLAG_UPDATE);
+  HAL_TIM_Base_Start_IT(&htim6);
+
+  return true;
+}
+
+void linStop(void)
+{
+  HAL_TIM_Base_Stop_IT(&htim6);
+  lin.is_run = false;
+}
+
+bool linIsRunning(void)
+{
+  return lin.is_run;
+}
+
+uint8_t linGetStatus(uint8_t slot)
+{
+  if (slot >= LIN_SLOT_MAX) return LIN_STATUS_NONE;
+
+  return lin_stat[slot].status;
+}
+
+// 슬롯마다 응답 확인 후 타이머 인터럽트에서 호출된다.
+//
+void linSetCallback(void (*p_func)(uint8_t slot, uint8_t status))
+{
+  lin.func = p_func;
+}
+
+uint8_t linMakePid(uint8_t id)
+{
+  uint8_t p0;
+  uint8_t p1;
+
+  id &= 0x3F;
+  p0 =  ((id >> 0) ^ (id >> 1) ^ (id >> 2) ^ (id >> 4)) & 0x01;
+  p1 = ~((id >> 1) ^ (id >> 3) ^ (id >> 4) ^ (id >> 5)) & 0x01;
+
+  return id | (p0 << 6) | (p1 << 7);
+}
+
+uint8_t linCalcChecksum(uint8_t pid, const uint8_t *p_data, uint8_t length, uint8_t type)
+{
+  uint16_t sum = 0;
+
+  if (type == LIN_CHECKSUM_ENHANCED && (pid & 0x3F) < 0x3C)
+  {
+    sum = pid;
+  }
+
+  for (int i=0; i<length; i++)
+  {
+    sum += p_data[i];
+    if (sum > 0xFF)
+    {
+      sum -= 0xFF;
+    }
+  }
+
+  return (uint8_t)~sum;
+}
+
+// TIM6 는 16비트라 65ms 보다 긴 시간은 나눠서 기다린다.
+//
+void linTimerSet(uint32_t us)
+{
+  lin.wait_us   = cmax(us, 2);
+  lin.period_us = cmin(lin.wait_us, 0xFFFF);
+  __HAL_TIM_SET_AUTORELOAD(&htim6, lin.period_us - 1);
+}
+
+void linTimerISR(void)
+{
+  if (lin.is_run != true)
+  {
+    return;
+  }
+
+  lin.wait_us -= lin.period_us;
+  if (lin.wait_us > 0)
+  {
+    linTimerSet(lin.wait_us);
+    return;
+  }
+
+  if (lin.state == LIN_STATE_HEADER)
+  {
+    linSendHeader();
+  }
+  else
+  {
+    linCheckResponse();
+  }
+}
+
+void linBreakISR(uint8_t ch)
+{
+  lin.break_det = true;
+  lin.break_cnt++;
+}
+
+// 브레이크 + 싱크 + PID 를 보내고, 마스터 응답이면 데이터와 체크섬까지 이어서 보낸다.
+// 응답 확인은 LIN 규격의 최대 프레임 시간(공칭의 1.4배) 뒤에 한다.
+//
+void linSendHeader(void)
+{
+  const lin_slot_t *p_slot;
+  uint32_t bits;
+
+
+  if (lin.sched_req == true)
+  {
+    lin.p_sched   = lin.p_sched_next;
+    lin.count     = lin.count_next;
+    lin.idx       = 0;
+    lin.sched_req = false;
+  }
+  p_slot = &lin.p_sched[lin.idx];
+
+  lin.tx_buf[0] = LIN_SYNC;
+  lin.tx_buf[1] = linMakePid(p_slot->id);
+  lin.tx_len    = 2;
+
+  if (p_slot->dir == LIN_DIR_TX)
+  {
+    memcpy(&lin.tx_buf[2], p_slot->p_data, p_slot->length);
+    lin.tx_buf[2 + p_slot->length] = linCalcChecksum(lin.tx_buf[1], p_slot->p_data, p_slot->length, p_slot->checksum);
+    lin.tx_len += p_slot->length + 1;
+  }
+
+  uartConsumeRx(lin.ch, uartAvailable(lin.ch));
+  lin.break_det = false;
+
+  uartLinSendBreak(lin.ch);
+  uartWrite(lin.ch, lin.tx_buf, lin.tx_len);
+
+  bits = LIN_HEADER_BITS + 10 * (p_slot->length + 1);
+  bits = bits * 14 / 10 + LIN_IDLE_BITS;
+  lin.frame_us = (uint32_t)((uint64_t)bits * 1000000 / lin.baud);
+
+  lin.state = LIN_STATE_RESPONSE;
+  linTimerSet(lin.frame_us);
+}
+
+// 단일선 버스라 보낸 헤더도 에코로 들어오므로 싱크/PID 뒤의 바이트를 응답으로 본다.
+//
+void linCheckResponse(void)
+{
+  const lin_slot_t *p_slot = &lin.p_sched[lin.idx];
+  uint8_t  rx_buf[2 + LIN_DATA_MAX + 1 + 4];
+  uint32_t rx_len;
+  uint32_t resp_len = 0;
+  uint8_t *p_resp = NULL;
+  uint8_t  status;
+  uint32_t slot_us;
+
+
+  rx_len = uartReadBuf(lin.ch, rx_buf, sizeof(rx_buf));
+  uartConsumeRx(lin.ch, uartAvailable(lin.ch));
+
+  for (uint32_t i=0; i+1<rx_len; i++)
+  {
+    if (rx_buf[i] == LIN_SYNC && rx_buf[i+1] == lin.tx_buf[1])
+    {
+      p_resp   = &rx_buf[i+2];
+      resp_len = rx_len - (i+2);
+      break;
+    }
+  }
+
+  if (lin.break_det != true)
+  {
+    status = LIN_STATUS_NO_BREAK;
+  }
+  else if (p_resp == NULL)
+  {
+    status = LIN_STATUS_BIT_ERR;
+  }
+  else if (resp_len == 0)
+  {
+    status = LIN_STATUS_TIMEOUT;
+  }
+  else if (resp_len < p_slot->length + 1U)
+  {
+    status = LIN_STATUS_SHORT;
+  }
+  else if (p_slot->dir == LIN_DIR_TX)
+  {
+    if (memcmp(p_resp, &lin.tx_buf[2], p_slot->length + 1) != 0)
+      status = LIN_STATUS_BIT_ERR;
+    else
+      status = LIN_STATUS_OK;
+  }
+  else
+  {
+    if (p_resp[p_slot->length] != linCalcChecksum(lin.tx_buf[1], p_resp, p_slot->length, p_slot->checksum))
+    {
+      status = LIN_STATUS_CHECKSUM;
+    }
+    else
+    {
+      memcpy(p_slot->p_data, p_resp, p_slot->length);
+      status = LIN_STATUS_OK;
+    }
+  }
+
+  lin_stat[lin.idx].status = status;
+  if (status == LIN_STATUS_OK)
+    lin_stat[lin.idx].ok_cnt++;
+  else
+    lin_stat[lin.idx].err_cnt++;
+
+  if (lin.func != NULL)
+  {
+    lin.func(lin.idx, status);
+  }
+
+  slot_us = (uint32_t)p_slot->slot_ms * 1000;
+  lin.idx = (lin.idx + 1) % lin.count;
+  lin.state = LIN_STATE_HEADER;
+  linTimerSet(slot_us > lin.frame_us + LIN_SLOT_GAP_MIN_US ? slot_us - lin.frame_us : LIN_SLOT_GAP_MIN_US);
+}
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  if (htim->Instance == htim6.Instance)
+  {
+    linTimerISR();
+  }
+}
+
+
+#ifdef _USE_HW_CLI
+static const char *linStatusStr(uint8_t status)
+{
+  const char *str[] = {"-", "OK", "TIMEOUT", "SHORT", "CHECKSUM", "BIT_ERR", "NO_BREAK"};
+
+  if (status > LIN_STATUS_NO_BREAK) return "?";
+
+  return str[status];
+}
+
+void cliLin(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    cliPrintf("ch    : _DEF_UART%d, %d bps, %s\n", lin.ch + 1, lin.baud, lin.is_open ? "open":"close");
+    cliPrintf("run   : %s\n", lin.is_run ? "on":"off");
+    cliPrintf("break : %d\n", lin.break_cnt);
+
+    for (int i=0; i<lin.count; i++)
+    {
+      const lin_slot_t *p_slot = &lin.p_sched[i];
+
+      cliPrintf("%02d : id 0x%02X(0x%02X) %s len %d %s %3dms, %-8s ok %d err %d\n",
+                i,
+                p_slot->id,
+                linMakePid(p_slot->id),
+                p_slot->dir == LIN_DIR_TX ? "TX":"RX",
+                p_slot->length,
+                p_slot->checksum == LIN_CHECKSUM_ENHANCED ? "enh":"cls",
+                p_slot->slot_ms,
+                linStatusStr(lin_stat[i].status),
+                lin_stat[i].ok_cnt,
+                lin_stat[i].err_cnt);
+    }
+    ret = true;
+  }
+
+  if (args->argc == 1 && args->isStr(0, "start"))
+  {
+    cliPrintf("lin start %s\n", linStart() ? "OK":"Fail");
+    ret = true;
+  }
+
+  if (args->argc == 1 && args->isStr(0, "stop"))
+  {
+    linStop();
+    cliPrintf("lin stop\n");
+    ret = true;
+  }
+
+  if (args->argc == 1 && args->isStr(0, "demo"))
+  {
+    linSetSchedule(lin_demo_sched, sizeof(lin_demo_sched)/sizeof(lin_slot_t));
+    cliPrintf("lin demo %s\n", linStart() ? "OK":"Fail");
+    ret = true;
+  }
+
+  if (ret == false)
+  {
+    cliPrintf("lin info\n");
+    cliPrintf("lin start\n");
+    cliPrintf("lin stop\n");
+    cliPrintf("lin demo\n");
+  }
+}
+#endif
+
+#endif
@@ -1,5 +1,7 @@
 #include "log.h"
 #include "uart.h"
+#include "qrecord.h"
+#include "slip.h"
 #ifdef _USE_HW_CLI
 #include "cli.h"
 #endif
@@ -13,31 +15,97 @@
 #endif
 
 
+#define LOG_REC_TIME        0     // micros64(), 8
+#define LOG_REC_LEVEL       8
+#define LOG_REC_HEAD_SIZE   9     // 시간 8 + 레벨 1
+#define LOG_REC_BOOT        0x80  // 레벨에 더해 기록 당시 부트 로그였음을 표시
+#define LOG_REC_TOKEN       0x40  // 문자열 대신 [토큰 u16][인자 u32 x n] 레코드
+#define LOG_REC_LEVEL_MASK  0x0F
+#define LOG_BUF_HEAD_MAX    32    // "FFFF [4294967295.999999]\t" + NUL
+
+// 타입 1 + 토큰 2 + 시간 8 + 레벨 1 + 인자, CRC 2 를 모두 ESC 한 최악의 경우 + END 2
+#define LOG_TOKEN_FRAME_MAX ((1 + 2 + 8 + 1 + LOG_TOKEN_ARGS_MAX * 4 + SLIP_CRC_SIZE) * 2 + 2)
+
+
+// 줄 단위 순환 저장소
+//
+// - 줄은 buf 안에 항상 연속으로 놓이고, 끝에 자리가 없으면 처음부터 기록한다.
+// - 줄 번호 n 의 위치와 길이는 line_off/line_len[n % line_max] 에 있다.
+// - 새 줄이 차지할 영역과 겹치는 가장 오래된 줄부터 버리므로 line_first ~ line_index-1 이
+//   항상 온전한 줄이고 순서대로 읽을 수 있다.
+//
 typedef struct
 {
-  uint16_t line_index;
-  uint16_t buf_length;
-  uint16_t buf_length_max;
-  uint16_t buf_index;
-  uint8_t *buf;
+  uint32_t  line_index;       // 다음에 기록할 줄 번호
+  uint32_t  line_first;       // 남아 있는 가장 오래된 줄 번호
+  uint16_t  line_max;
+  uint16_t *line_off;
+  uint16_t *line_len;
+
+  uint16_t  buf_length;       // 남아 있는 줄의 길이 합
+  uint16_t  buf_length_max;
+  uint16_t  buf_index;        // 다음에 기록할 위치
+  uint8_t  *buf;
 } log_buf_t;
 
 
 log_buf_t log_buf_boot;
 log_buf_t log_buf_list;
 
-static uint8_t buf_boot[LOG_BOOT_BUF_MAX];
-static uint8_t buf_list[LOG_LIST_BUF_MAX];
+static uint8_t  buf_boot[LOG_BOOT_BUF_MAX];
+static uint8_t  buf_list[LOG_LIST_BUF_MAX];
+static uint16_t line_off_boot[LOG_BOOT_LINE_MAX];
+static uint16_t line_len_boot[LOG_BOOT_LINE_MAX];
+static uint16_t line_off_list[LOG_LIST_LINE_MAX];
+static uint16_t line_len_list[LOG_LIST_LINE_MAX];
 
 static bool is_init = false;
 static bool is_boot_log = true;
 static bool is_enable = true;
 static bool is_open = false;
+static bool is_tail = false;    // log tail -f 가 CLI 포트로 직접 출력하는 중
 
 static uint8_t  log_ch = LOG_CH;
 static uint32_t log_baud = 115200;
 
-static char print_buf[256];
+static char print_buf[LOG_LINE_MAX];
+
+// 호출한 곳에서는 [시간][레벨][문자열] 레코드만 링에 넣고, 출력과 boot/list 버퍼 기록은
+// logUpdate() 가 메인 루프에서 한다.
+//
+static qrecord_t log_ring;
+static uint8_t   log_ring_buf[LOG_RING_BUF_MAX];
+static volatile uint32_t log_drop_cnt = 0;
+static uint32_t  log_rec_cnt = 0;
+static uint32_t  log_token_cnt = 0;
+
+volatile uint8_t log_mod_level[LOG_MOD_MAX];
+
+// 컴파일 레벨, 실행 레벨은 이보다 높일 수 없다.
+//
+static const uint8_t log_mod_ct_level[LOG_MOD_MAX] =
+{
+  [LOG_MOD_HW]     = LOG_CT_LEVEL_HW,
+  [LOG_MOD_UART]   = LOG_CT_LEVEL_UART,
+  [LOG_MOD_LIN]    = LOG_CT_LEVEL_LIN,
+  [LOG_MOD_MODBUS] = LOG_CT_LEVEL_MODBUS,
+  [LOG_MOD_PACKET] = LOG_CT_LEVEL_PACKET,
+  [LOG_MOD_CLI]    = LOG_CT_LEVEL_CLI,
+  [LOG_MOD_AP]     = LOG_CT_LEVEL_AP,
+};
+
+static const char *log_mod_name[LOG_MOD_MAX] =
+{
+  [LOG_MOD_HW]     = "hw",
+  [LOG_MOD_UART]   = "uart",
+  [LOG_MOD_LIN]    = "lin",
+  [LOG_MOD_MODBUS] = "modbus",
+  [LOG_MOD_PACKET] = "packet",
+  [LOG_MOD_CLI]    = "cli",
+  [LOG_MOD_AP]     = "ap",
+};
+
+static const char *log_level_name[] = {"error", "warn", "info", "debug", "trace"};
 
 #ifdef _USE_HW_RTOS
 static SemaphoreHandle_t mutex_lock;
@@ -48,6 +116,10 @@ static SemaphoreHandle_t mutex_lock;
 #ifdef _USE_HW_CLI
 static void cliCmd(cli_args_t *args);
 #endif
+static void logBufCreate(log_buf_t *p_log, uint8_t *p_buf, uint16_t length, uint16_t *p_off, uint16_t *p_len, uint16_t line_max);
+static bool logBufPrintf(log_buf_t *p_log, uint64_t time_us, char *p_data, uint32_t length);
+static uint32_t logBufGetLine(log_buf_t *p_log, uint32_t line, uint8_t **p_data);
+static uint32_t logTokenEncode(uint8_t *p_rec, uint32_t rec_len, uint8_t *p_out);
 
 
 
@@ -59,19 +131,19 @@ bool logInit(void)
   mutex_lock = xSemaphoreCreateMutex();
 #endif
 
-  log_buf_boot.line_index     = 0;
-  log_buf_boot.buf_length     = 0;
-  log_buf_boot.buf_length_max = LOG_BOOT_BUF_MAX;
-  log_buf_boot.buf_index      = 0;
-  log_buf_boot.buf            = buf_boot;
+  logBufCreate(&log_buf_boot, buf_boot, LOG_BOOT_BUF_MAX, line_off_boot, line_len_boot, LOG_BOOT_LINE_MAX);
+  logBufCreate(&log_buf_list, buf_list, LOG_LIST_BUF_MAX, line_off_list, line_len_list, LOG_LIST_LINE_MAX);
 
+  qrecordCreate(&log_ring, log_ring_buf, LOG_RING_BUF_MAX);
+  qbufferRegister(&log_ring.qbuffer, "log");
+  log_drop_cnt = 0;
+  log_rec_cnt  = 0;
+  log_token_cnt = 0;
 
-  log_buf_list.line_index     = 0;
-  log_buf_list.buf_length     = 0;
-  log_buf_list.buf_length_max = LOG_LIST_BUF_MAX;
-  log_buf_list.buf_index      = 0;
-  log_buf_list.buf            = buf_list;
-
+  for (int i=0; i<LOG_MOD_MAX; i++)
+  {
+    log_mod_level[i] = log_mod_ct_level[i];
+  }
 
   is_init = true;
 
@@ -107,75 +179,371 @@ bool logOpen(uint8_t ch, uint32_t baud)
   return is_open;
 }
 
-bool logBufPrintf(log_buf_t *p_log, char *p_data, uint32_t length)
+void logBufCreate(log_buf_t *p_log, uint8_t *p_buf, uint16_t length, uint16_t *p_off, uint16_t *p_len, uint16_t line_max)
 {
-  uint32_t buf_last;
-  uint8_t *p_buf;
-  int buf_len;
-
+  p_log->line_index     = 0;
+  p_log->line_first     = 0;
+  p_log->line_max       = line_max;
+  p_log->line_off       = p_off;
+  p_log->line_len       = p_len;
+
+  p_log->buf_length     = 0;
+  p_log->buf_length_max = length;
+  p_log->buf_index      = 0;
+  p_log->buf            = p_buf;
+}
 
-  buf_last = p_log->buf_index + length + 8;
-  if (buf_last > p_log->buf_length_max)
+// [begin, end) 영역과 가장 오래된 줄이 겹치면 그 줄을 버린다.
+//
+static void logBufDrop(log_buf_t *p_log, uint32_t begin, uint32_t end)
+{
+  while(p_log->line_first != p_log->line_index)
   {
-    p_log->buf_index = 0;
-    buf_last = p_log->buf_index + length + 8;
+    uint32_t i   = p_log->line_first % p_log->line_max;
+    uint32_t off = p_log->line_off[i];
 
-    if (buf_last > p_log->buf_length_max)
+    if (off >= end || off + p_log->line_len[i] <= begin)
     {
-      return false;
+      break;
     }
+    p_log->buf_length -= p_log->line_len[i];
+    p_log->line_first++;
   }
+}
 
-  p_buf = &p_log->buf[p_log->buf_index];
+// 줄마다 순번과 micros64() 시간(초.마이크로초)을 붙인다.
+//
+bool logBufPrintf(log_buf_t *p_log, uint64_t time_us, char *p_data, uint32_t length)
+{
+  char     head[LOG_BUF_HEAD_MAX];
+  uint32_t head_len;
+  uint32_t line_len;
+  uint32_t off;
+  uint32_t i;
+
+
+  head_len = snprintf(head, sizeof(head), "%04X [%lu.%06lu]\t",
+                      (unsigned int)(p_log->line_index & 0xFFFF),
+                      (unsigned long)(time_us / 1000000),
+                      (unsigned long)(time_us % 1000000));
+  line_len = head_len + length;
+  if (line_len > p_log->buf_length_max)
+  {
+    return false;
+  }
 
-  buf_len = snprintf((char *)p_buf, length + 8, "%04X\t%s", p_log->line_index, p_data);
+  // 끝에 들어가지 않으면 끝 구간의 줄을 버리고 처음부터 기록한다.
+  //
+  off = p_log->buf_index;
+  if (off + line_len > p_log->buf_length_max)
+  {
+    logBufDrop(p_log, off, p_log->buf_length_max);
+    off = 0;
+  }
+  logBufDrop(p_log, off, off + line_len);
+
+  // 인덱스가 가득 차면 가장 오래된 줄을 버린다.
+  //
+  if (p_log->line_index - p_log->line_first >= p_log->line_max)
+  {
+    p_log->buf_length -= p_log->line_len[p_log->line_first % p_log->line_max];
+    p_log->line_first++;
+  }
+
+  memcpy(&p_log->buf[off], head, head_len);
+  memcpy(&p_log->buf[off + head_len], p_data, length);
+
+  i = p_log->line_index % p_log->line_max;
+  p_log->line_off[i] = off;
+  p_log->line_len[i] = line_len;
   p_log->line_index++;
-  p_log->buf_index += buf_len;
 
+  p_log->buf_length += line_len;
+  p_log->buf_index   = off + line_len;
+
+  return true;
+}
 
-  if (buf_len + p_log->buf_length <= p_log->buf_length_max)
+// 줄 번호 line 의 위치와 길이, 이미 버려졌거나 아직 없으면 0
+//
+uint32_t logBufGetLine(log_buf_t *p_log, uint32_t line, uint8_t **p_data)
+{
+  uint32_t i;
+
+
+  if (line - p_log->line_first >= p_log->line_index - p_log->line_first)
   {
-    p_log->buf_length += buf_len;
+    return 0;
   }
 
-  return true;
+  i = line % p_log->line_max;
+  *p_data = &p_log->buf[p_log->line_off[i]];
+
+  return p_log->line_len[i];
+}
+
+// 인터럽트에서도 호출할 수 있다. 문자열은 호출한 곳의 스택에서 만들고,
+// 링에 복사하는 동안만 인터럽트를 막는다. (여러 생산자 직렬화)
+// 링이 가득 차면 기다리지 않고 버린 뒤 log_drop_cnt 를 올린다.
+//
+void logVPrintf(uint8_t level, const char *fmt, va_list args)
+{
+  char     buf[LOG_LINE_MAX];
+  int      len;
+  uint64_t time_us;
+  uint32_t primask;
+  uint8_t *p_rec;
+
+
+  if (is_init != true) return;
+
+  time_us = micros64();
+  len = vsnprintf(buf, LOG_LINE_MAX, fmt, args);
+  if (len <= 0)
+  {
+    return;
+  }
+  len = cmin(len, LOG_LINE_MAX - 1);
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  p_rec = qrecordReserve(&log_ring, LOG_REC_HEAD_SIZE + len);
+  if (p_rec != NULL)
+  {
+    memcpy(&p_rec[LOG_REC_TIME], &time_us, 8);
+    p_rec[LOG_REC_LEVEL] = level | (is_boot_log ? LOG_REC_BOOT:0);
+    memcpy(&p_rec[LOG_REC_HEAD_SIZE], buf, len);
+    qrecordCommit(&log_ring, LOG_REC_HEAD_SIZE + len);
+  }
+  else
+  {
+    log_drop_cnt++;
+  }
+
+  __set_PRIMASK(primask);
 }
 
 void logPrintf(const char *fmt, ...)
 {
-#ifdef _USE_HW_RTOS
-  lock();
-#endif
+  va_list args;
+
+
+  va_start(args, fmt);
+  logVPrintf(LOG_LEVEL_INFO, fmt, args);
+  va_end(args);
+}
 
+void logPrintfLevel(uint8_t level, const char *fmt, ...)
+{
   va_list args;
-  int len;
+
+
+  va_start(args, fmt);
+  logVPrintf(level, fmt, args);
+  va_end(args);
+}
+
+// logToken() 에서 호출, 형식화 없이 토큰과 인자만 링에 넣는다.
+//
+void logTokenWrite(uint8_t level, uint32_t token, const uint32_t *p_args, uint32_t count)
+{
+  uint64_t time_us;
+  uint32_t primask;
+  uint32_t len;
+  uint8_t *p_rec;
+
 
   if (is_init != true) return;
 
+  time_us = micros64();
+  count   = cmin(count, LOG_TOKEN_ARGS_MAX);
+  len     = LOG_REC_HEAD_SIZE + 2 + count * 4;
 
-  va_start(args, fmt);
-  len = vsnprintf(print_buf, 256, fmt, args);
+  primask = __get_PRIMASK();
+  __disable_irq();
 
-  if (is_open == true && is_enable == true)
+  p_rec = qrecordReserve(&log_ring, len);
+  if (p_rec != NULL)
+  {
+    memcpy(&p_rec[LOG_REC_TIME], &time_us, 8);
+    p_rec[LOG_REC_LEVEL] = level | LOG_REC_TOKEN | (is_boot_log ? LOG_REC_BOOT:0);
+    p_rec[LOG_REC_HEAD_SIZE + 0] = token >> 0;
+    p_rec[LOG_REC_HEAD_SIZE + 1] = token >> 8;
+    memcpy(&p_rec[LOG_REC_HEAD_SIZE + 2], p_args, count * 4);
+    qrecordCommit(&log_ring, len);
+  }
+  else
   {
-    uartWrite(log_ch, (uint8_t *)print_buf, len);
+    log_drop_cnt++;
   }
 
-  if (is_boot_log)
+  __set_PRIMASK(primask);
+}
+
+// 토큰 레코드를 SLIP 프레임으로 만든다. 리턴은 프레임 길이
+//
+uint32_t logTokenEncode(uint8_t *p_rec, uint32_t rec_len, uint8_t *p_out)
+{
+  slip_enc_t enc;
+  uint32_t   len;
+
+
+  len  = slipEncodeBegin(&enc, &p_out[0]);
+  len += slipEncodeByte(&enc, LOG_TOKEN_FRAME_TYPE, &p_out[len]);
+  len += slipEncodeByte(&enc, p_rec[LOG_REC_HEAD_SIZE + 0], &p_out[len]);
+  len += slipEncodeByte(&enc, p_rec[LOG_REC_HEAD_SIZE + 1], &p_out[len]);
+  for (int i=0; i<8; i++)
+  {
+    len += slipEncodeByte(&enc, p_rec[LOG_REC_TIME + i], &p_out[len]);
+  }
+  len += slipEncodeByte(&enc, p_rec[LOG_REC_LEVEL] & LOG_REC_LEVEL_MASK, &p_out[len]);
+  for (uint32_t i=LOG_REC_HEAD_SIZE + 2; i<rec_len; i++)
   {
-    logBufPrintf(&log_buf_boot, print_buf, len);
+    len += slipEncodeByte(&enc, p_rec[i], &p_out[len]);
   }
-  logBufPrintf(&log_buf_list, print_buf, len);
+  len += slipEncodeEnd(&enc, &p_out[len]);
+
+  return len;
+}
+
+// 메인 루프(유휴 시간)에서 호출한다. UART TX 링에 자리가 있는 만큼만 꺼내므로 기다리지 않는다.
+//
+void logUpdate(void)
+{
+  uint8_t *p_rec;
+  uint32_t rec_len;
+  uint32_t len;
+  uint64_t time_us;
 
-  va_end(args);
+
+  if (is_init != true) return;
+
+  while((rec_len = qrecordPeek(&log_ring, &p_rec)) > 0)
+  {
+    // 토큰 레코드는 PC 에서만 문자열로 만들 수 있으므로 boot/list 버퍼에는 넣지 않는다.
+    //
+    if (p_rec[LOG_REC_LEVEL] & LOG_REC_TOKEN)
+    {
+      uint8_t frame[LOG_TOKEN_FRAME_MAX];
+
+      if (is_open == true && is_enable == true && is_tail != true)
+      {
+        len = logTokenEncode(p_rec, rec_len, frame);
+        if (uartAvailableForWrite(log_ch) < len)
+        {
+          break;
+        }
+        uartWrite(log_ch, frame, len);
+      }
+      qrecordRelease(&log_ring);
+      log_rec_cnt++;
+      log_token_cnt++;
+      continue;
+    }
+
+    len = rec_len - LOG_REC_HEAD_SIZE;
+
+    if (is_open == true && is_enable == true && is_tail != true)
+    {
+      if (uartAvailableForWrite(log_ch) < len)
+      {
+        break;
+      }
+      uartWrite(log_ch, &p_rec[LOG_REC_HEAD_SIZE], len);
+    }
+
+    memcpy(&time_us, &p_rec[LOG_REC_TIME], 8);
 
 #ifdef _USE_HW_RTOS
-  unLock();
+    lock();
+#endif
+    memcpy(print_buf, &p_rec[LOG_REC_HEAD_SIZE], len);
+    print_buf[len] = 0;
+
+    if (p_rec[LOG_REC_LEVEL] & LOG_REC_BOOT)
+    {
+      logBufPrintf(&log_buf_boot, time_us, print_buf, len);
+    }
+    logBufPrintf(&log_buf_list, time_us, print_buf, len);
+#ifdef _USE_HW_RTOS
+    unLock();
 #endif
+
+    qrecordRelease(&log_ring);
+    log_rec_cnt++;
+  }
+}
+
+// 쌓인 로그를 모두 내보낸다. (리셋 전, Fault/Error 처리)
+// 인터럽트가 막혀 있으면 uartFlushTx() 가 TX 링을 폴링으로 비우므로 millis() 없이
+// 더 이상 꺼낼 레코드가 없을 때까지 반복한다.
+//
+void logFlush(void)
+{
+  uint32_t rec_cnt;
+
+
+  if (is_init != true) return;
+
+  do
+  {
+    uartFlushTx(log_ch);
+    rec_cnt = log_rec_cnt;
+    logUpdate();
+  } while(log_rec_cnt != rec_cnt && qrecordIsEmpty(&log_ring) != true);
+
+  uartFlushTx(log_ch);
+}
+
+uint32_t logGetDropCount(void)
+{
+  return log_drop_cnt;
+}
+
+// 모듈의 실행 레벨을 바꾼다. 컴파일 레벨보다 높게 주면 컴파일 레벨로 제한된다.
+//
+bool logSetModuleLevel(uint8_t mod, uint8_t level)
+{
+  if (mod >= LOG_MOD_MAX) return false;
+
+  log_mod_level[mod] = cmin(level, log_mod_ct_level[mod]);
+
+  return true;
 }
 
 
 #ifdef _USE_HW_CLI
+// 가장 최근 count 줄을 순서대로 출력하고 다음 줄 번호를 돌려준다.
+//
+static uint32_t logShowLines(log_buf_t *p_log, uint32_t count)
+{
+  uint32_t line;
+  uint8_t *p_data;
+  uint32_t len;
+
+
+#ifdef _USE_HW_RTOS
+  lock();
+#endif
+  line = p_log->line_first;
+  if (p_log->line_index - line > count)
+  {
+    line = p_log->line_index - count;
+  }
+
+  for (; line != p_log->line_index; line++)
+  {
+    len = logBufGetLine(p_log, line, &p_data);
+    cliWrite(p_data, len);
+  }
+#ifdef _USE_HW_RTOS
+  unLock();
+#endif
+
+  return line;
+}
+
 void cliCmd(cli_args_t *args)
 {
   bool ret = false;
@@ -184,77 +552,107 @@ void cliCmd(cli_args_t *args)
 
   if (args->argc == 1 && args->isStr(0, "info"))
   {
-    cliPrintf("boot.line_index %d\n", log_buf_boot.line_index);
-    cliPrintf("boot.buf_length %d\n", log_buf_boot.buf_length);
+    cliPrintf("boot.line       %d ~ %d\n", log_buf_boot.line_first, log_buf_boot.line_index);
+    cliPrintf("boot.buf_length %d/%d\n", log_buf_boot.buf_length, log_buf_boot.buf_length_max);
+    cliPrintf("\n");
+    cliPrintf("list.line       %d ~ %d\n", log_buf_list.line_first, log_buf_list.line_index);
+    cliPrintf("list.buf_length %d/%d\n", log_buf_list.buf_length, log_buf_list.buf_length_max);
     cliPrintf("\n");
-    cliPrintf("list.line_index %d\n", log_buf_list.line_index);
-    cliPrintf("list.buf_length %d\n", log_buf_list.buf_length);
+    cliPrintf("ring.rec_cnt    %d\n", log_rec_cnt);
+    cliPrintf("ring.drop_cnt   %d\n", log_drop_cnt);
+    cliPrintf("ring.token_cnt  %d\n", log_token_cnt);
 
     ret = true;
   }
 
   if (args->argc == 1 && args->isStr(0, "boot"))
   {
-    uint32_t index = 0;
-
-    while(cliKeepLoop())
-    {
-      uint32_t buf_len;
-
-      buf_len = log_buf_boot.buf_length - index;
-      if (buf_len == 0)
-      {
-        break;
-      }
-      if (buf_len > 64)
-      {
-        buf_len = 64;
-      }
-
-      #ifdef _USE_HW_RTOS
-      lock();
-      #endif
+    logShowLines(&log_buf_boot, UINT32_MAX);
+    ret = true;
+  }
 
-      cliWrite((uint8_t *)&log_buf_boot.buf[index], buf_len);
-      index += buf_len;
+  if ((args->argc == 1 || args->argc == 2) && args->isStr(0, "list"))
+  {
+    uint32_t count = UINT32_MAX;
 
-      #ifdef _USE_HW_RTOS
-      unLock();
-      #endif
+    if (args->argc == 2)
+    {
+      count = args->getData(1);
     }
+    logShowLines(&log_buf_list, count);
     ret = true;
   }
 
-  if (args->argc == 1 && args->isStr(0, "list"))
+  // 메인 루프가 멈춰 있으므로 직접 logUpdate() 를 돌리며 새 줄을 출력한다. 아무 키나 누르면 끝
+  // 로그 포트가 CLI 포트와 같으면 logUpdate() 의 UART 출력은 막고 줄 버퍼에서만 출력한다.
+  //
+  if (args->argc == 2 && args->isStr(0, "tail") && args->isStr(1, "-f"))
   {
-    uint32_t index = 0;
+    uint32_t line;
+
+    line = logShowLines(&log_buf_list, 10);
+    is_tail = (log_ch == cliGetPort());
 
     while(cliKeepLoop())
     {
-      uint32_t buf_len;
+      logUpdate();
 
-      buf_len = log_buf_list.buf_length - index;
-      if (buf_len == 0)
+      if (line < log_buf_list.line_first)
       {
-        break;
+        cliPrintf("... %d lines lost\n", log_buf_list.line_first - line);
+        line = log_buf_list.line_first;
       }
-      if (buf_len > 64)
+      while(line != log_buf_list.line_index)
       {
-        buf_len = 64;
-      }
+        uint8_t *p_data;
+        uint32_t len;
 
-      #ifdef _USE_HW_RTOS
-      lock();
-      #endif
+        len = logBufGetLine(&log_buf_list, line, &p_data);
+        cliWrite(p_data, len);
+        line++;
+      }
+    }
+    is_tail = false;
+    cliRead();
+    ret = true;
+  }
 
-      cliWrite((uint8_t *)&log_buf_list.buf[index], buf_len);
-      index += buf_len;
+  if (args->argc == 1 && args->isStr(0, "level"))
+  {
+    for (int i=0; i<LOG_MOD_MAX; i++)
+    {
+      cliPrintf("%-8s : %-6s (build %s)\n",
+                log_mod_name[i],
+                log_level_name[log_mod_level[i]],
+                log_level_name[log_mod_ct_level[i]]);
+    }
+    ret = true;
+  }
 
-      #ifdef _USE_HW_RTOS
-      unLock();
-      #endif
+  if (args->argc == 3 && args->isStr(0, "level"))
+  {
+    int mod   = -1;
+    int level = -1;
 
+    for (int i=0; i<LOG_LEVEL_TRACE+1; i++)
+    {
+      if (args->isStr(2, log_level_name[i]))
+        level = i;
     }
+    for (int i=0; i<LOG_MOD_MAX; i++)
+    {
+      if (args->isStr(1, log_mod_name[i]) || args->isStr(1, "all"))
+      {
+        mod = i;
+        if (level >= 0)
+          logSetModuleLevel(i, level);
+      }
+    }
+
+    if (mod >= 0 && level >= 0)
+      cliPrintf("log level %s %s\n", args->getStr(1), args->getStr(2));
+    else
+      cliPrintf("unknown module or level\n");
     ret = true;
   }
 
@@ -262,7 +660,9 @@ void cliCmd(cli_args_t *args)
   {
     cliPrintf("log info\n");
     cliPrintf("log boot\n");
-    cliPrintf("log list\n");
+    cliPrintf("log list [count]\n");
+    cliPrintf("log tail -f\n");
+    cliPrintf("log level [mod|all error|warn|info|debug|trace]\n");
   }
 }
 #endif
@@ -0,0 +1,428 @@
+#include "modbus.h"
+#include "uart.h"
+#include "util.h"
+#include "cli.h"
+#include "log.h"
+
+
+#ifdef _USE_HW_MODBUS
+
+
+#define MODBUS_ID_BROADCAST     0
+#define MODBUS_READ_MAX         125
+#define MODBUS_WRITE_MAX        123
+#define MODBUS_T35_FIXED_US     1750      // 19200bps 초과 시 규격의 고정 t3.5
+
+
+typedef struct
+{
+  bool     is_open;
+  uint8_t  ch;
+  uint32_t baud;
+  uint8_t  id;
+  uint32_t t35_bits;
+
+  const modbus_map_t *p_map;
+
+  uint32_t rx_frame;
+  uint32_t rx_other;      // 다른 슬레이브 주소
+  uint32_t crc_err;
+  uint32_t len_err;
+  uint32_t ex_cnt;
+  uint32_t tx_frame;
+} modbus_t;
+
+
+#ifdef _USE_HW_CLI
+static void cliModbus(cli_args_t *args);
+#endif
+static void modbusRxTimeout(uint8_t ch);
+static uint8_t modbusRegRead(uint8_t type, uint16_t addr, uint16_t count, uint16_t *p_data);
+static uint8_t modbusRegWrite(uint16_t addr, uint16_t count, const uint16_t *p_data);
+
+
+static modbus_t modbus;
+static uint8_t  modbus_req[MODBUS_FRAME_MAX];
+static uint8_t  modbus_resp[MODBUS_FRAME_MAX];
+static uint16_t modbus_reg[HW_MODBUS_REG_MAX];    // 맵을 등록하지 않았을 때 쓰는 기본 레지스터
+
+static const modbus_map_t modbus_map_default =
+{
+  .read  = modbusRegRead,
+  .write = modbusRegWrite,
+};
+
+
+bool modbusInit(void)
+{
+  modbus.is_open  = false;
+  modbus.ch       = HW_MODBUS_CH;
+  modbus.baud     = 0;
+  modbus.id       = HW_MODBUS_ID;
+  modbus.t35_bits = 0;
+  modbus.p_map    = &modbus_map_default;
+
+  modbus.rx_frame = 0;
+  modbus.rx_other = 0;
+  modbus.crc_err  = 0;
+  modbus.len_err  = 0;
+  modbus.ex_cnt   = 0;
+  modbus.tx_frame = 0;
+
+  for (int i=0; i<HW_MODBUS_REG_MAX; i++)
+  {
+    modbus_reg[i] = 0;
+  }
+
+#ifdef _USE_HW_CLI
+  cliAdd("modbus", cliModbus);
+#endif
+
+  return true;
+}
+
+// 프레임 끝(t3.5)은 USART 수신 타임아웃(RTO)으로 검출한다.
+// 19200bps 이하는 3.5 문자(11비트 기준), 초과는 고정 1.75ms
+//
+bool modbusOpen(uint8_t ch, uint32_t baud, uint8_t id)
+{
+  modbus.ch   = ch;
+  modbus.baud = baud;
+  modbus.id   = id;
+
+  if (baud <= 19200)
+    modbus.t35_bits = (35 * 11 + 9) / 10;
+  else
+    modbus.t35_bits = (uint32_t)((uint64_t)MODBUS_T35_FIXED_US * baud / 1000000);
+
+  // 수신 타임아웃 인터럽트가 RX 링을 읽고 TX 링에 쓰므로 채널을 차지한다.
+  //
+  if (uartSetOwner(ch, "modbus") != true)
+  {
+    modbus.is_open = false;
+    return false;
+  }
+
+  modbus.is_open = uartOpen(ch, baud);
+  if (modbus.is_open == true)
+  {
+    modbus.is_open = uartSetRxTimeout(ch, modbus.t35_bits, modbusRxTimeout);
+  }
+  if (modbus.is_open != true)
+  {
+    uartSetOwner(ch, NULL);
+  }
+
+  return modbus.is_open;
+}
+
+void modbusSetMap(const modbus_map_t *p_map)
+{
+  if (p_map == NULL)
+    modbus.p_map = &modbus_map_default;
+  else
+    modbus.p_map = p_map;
+}
+
+// t3.5 가 지나면 수신 링에 쌓인 바이트가 한 프레임이다.
+// IDLE 이벤트(1 문자)가 RTO(3.5 문자)보다 먼저 오므로 이미 링에 공개되어 있고,
+// 인터럽트에서 바로 응답을 TX DMA 에 넣어 프레임 간격 직후에 응답이 나간다.
+//
+void modbusRxTimeout(uint8_t ch)
+{
+  uint32_t req_len;
+  uint32_t resp_len;
+
+
+  req_len = uartAvailable(ch);
+  if (req_len > MODBUS_FRAME_MAX)
+  {
+    modbus.len_err++;
+    uartConsumeRx(ch, req_len);
+    return;
+  }
+
+  req_len  = uartReadBuf(ch, modbus_req, req_len);
+  resp_len = modbusProcessFrame(modbus_req, req_len, modbus_resp);
+  if (resp_len > 0)
+  {
+    uartWrite(ch, modbus_resp, resp_len);
+    modbus.tx_frame++;
+  }
+}
+
+static uint16_t modbusGetU16(const uint8_t *p_data)
+{
+  return (p_data[0] << 8) | p_data[1];
+}
+
+static void modbusSetU16(uint8_t *p_data, uint16_t data)
+{
+  p_data[0] = data >> 8;
+  p_data[1] = data >> 0;
+}
+
+// 요청 프레임(주소 ~ CRC)을 처리하고 응답 프레임 길이를 돌려준다. 0 이면 응답 없음
+// UART 와 무관하게 프레임만 다루므로 모의 마스터의 요청을 그대로 넣어 확인할 수 있다.
+//
+uint32_t modbusProcessFrame(const uint8_t *p_req, uint32_t req_len, uint8_t *p_resp)
+{
+  uint16_t crc = 0xFFFF;
+  uint8_t  func;
+  const uint8_t *p_pdu;
+  uint32_t pdu_len;
+  uint32_t resp_len = 0;
+  uint8_t  ex = MODBUS_EX_NONE;
+  uint16_t regs[MODBUS_READ_MAX];
+
+
+  if (req_len < 4)
+  {
+    modbus.len_err++;
+    return 0;
+  }
+
+  // CRC 까지 포함해 계산하면 0 이 된다.
+  //
+  for (uint32_t i=0; i<req_len; i++)
+  {
+    utilUpdateCrcModbus(&crc, p_req[i]);
+  }
+  if (crc != 0)
+  {
+    modbus.crc_err++;
+    LOG_D(MODBUS, "modbus crc err, len %d\n", req_len);
+    return 0;
+  }
+
+  if (p_req[0] != modbus.id && p_req[0] != MODBUS_ID_BROADCAST)
+  {
+    modbus.rx_other++;
+    return 0;
+  }
+  modbus.rx_frame++;
+
+  func    = p_req[1];
+  p_pdu   = &p_req[2];
+  pdu_len = req_len - 4;
+
+  p_resp[0] = modbus.id;
+  p_resp[1] = func;
+
+  switch(func)
+  {
+    case 0x03:    // Read Holding Registers
+    case 0x04:    // Read Input Registers
+      {
+        uint16_t addr;
+        uint16_t count;
+
+        if (pdu_len != 4)
+        {
+          ex = MODBUS_EX_ILLEGAL_VALUE;
+          break;
+        }
+        addr  = modbusGetU16(&p_pdu[0]);
+        count = modbusGetU16(&p_pdu[2]);
+        if (count == 0 || count > MODBUS_READ_MAX)
+        {
+          ex = MODBUS_EX_ILLEGAL_VALUE;
+          break;
+        }
+        if ((uint32_t)addr + count > 0x10000)
+        {
+          ex = MODBUS_EX_ILLEGAL_ADDRESS;
+          break;
+        }
+
+        ex = modbus.p_map->read(func == 0x03 ? MODBUS_REG_HOLDING:MODBUS_REG_INPUT, addr, count, regs);
+        if (ex != MODBUS_EX_NONE)
+        {
+          break;
+        }
+
+        p_resp[2] = count * 2;
+        for (int i=0; i<count; i++)
+        {
+          modbusSetU16(&p_resp[3 + i*2], regs[i]);
+        }
+        resp_len = 3 + count * 2;
+      }
+      break;
+
+    case 0x06:    // Write Single Register
+      {
+        uint16_t addr;
+        uint16_t data;
+
+        if (pdu_len != 4)
+        {
+          ex = MODBUS_EX_ILLEGAL_VALUE;
+          break;
+        }
+        addr = modbusGetU16(&p_pdu[0]);
+        data = modbusGetU16(&p_pdu[2]);
+
+        ex = modbus.p_map->write(addr, 1, &data);
+        if (ex != MODBUS_EX_NONE)
+        {
+          break;
+        }
+
+        memcpy(&p_resp[2], p_pdu, 4);
+        resp_len = 6;
+      }
+      break;
+
+    case 0x10:    // Write Multiple Registers
+      {
+        uint16_t addr;
+        uint16_t count;
+
+        if (pdu_len < 5)
+        {
+          ex = MODBUS_EX_ILLEGAL_VALUE;
+          break;
+        }
+        addr  = modbusGetU16(&p_pdu[0]);
+        count = modbusGetU16(&p_pdu[2]);
+        if (count == 0 || count > MODBUS_WRITE_MAX || p_pdu[4] != count * 2 || pdu_len != 5U + count * 2)
+        {
+          ex = MODBUS_EX_ILLEGAL_VALUE;
+          break;
+        }
+        if ((uint32_t)addr + count > 0x10000)
+        {
+          ex = MODBUS_EX_ILLEGAL_ADDRESS;
+          break;
+        }
+
+        for (int i=0; i<count; i++)
+        {
+          regs[i] = modbusGetU16(&p_pdu[5 + i*2]);
+        }
+        ex = modbus.p_map->write(addr, count, regs);
+        if (ex != MODBUS_EX_NONE)
+        {
+          break;
+        }
+
+        memcpy(&p_resp[2], p_pdu, 4);
+        resp_len = 6;
+      }
+      break;
+
+    default:
+      ex = MODBUS_EX_ILLEGAL_FUNCTION;
+      break;
+  }
+
+  if (ex != MODBUS_EX_NONE)
+  {
+    modbus.ex_cnt++;
+    LOG_T(MODBUS, "modbus func 0x%02X ex %d\n", func, ex);
+    p_resp[1] = func | 0x80;
+    p_resp[2] = ex;
+    resp_len  = 3;
+  }
+
+  // 브로드캐스트는 처리만 하고 응답하지 않는다.
+  //
+  if (p_req[0] == MODBUS_ID_BROADCAST)
+  {
+    return 0;
+  }
+
+  crc = 0xFFFF;
+  for (uint32_t i=0; i<resp_len; i++)
+  {
+    utilUpdateCrcModbus(&crc, p_resp[i]);
+  }
+  p_resp[resp_len++] = crc >> 0;
+  p_resp[resp_len++] = crc >> 8;
+
+  return resp_len;
+}
+
+uint8_t modbusRegRead(uint8_t type, uint16_t addr, uint16_t count, uint16_t *p_data)
+{
+  if ((uint32_t)addr + count > HW_MODBUS_REG_MAX)
+  {
+    return MODBUS_EX_ILLEGAL_ADDRESS;
+  }
+
+  memcpy(p_data, &modbus_reg[addr], count * 2);
+
+  return MODBUS_EX_NONE;
+}
+
+uint8_t modbusRegWrite(uint16_t addr, uint16_t count, const uint16_t *p_data)
+{
+  if ((uint32_t)addr + count > HW_MODBUS_REG_MAX)
+  {
+    return MODBUS_EX_ILLEGAL_ADDRESS;
+  }
+
+  memcpy(&modbus_reg[addr], p_data, count * 2);
+
+  return MODBUS_EX_NONE;
+}
+
+
+#ifdef _USE_HW_CLI
+void cliModbus(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    cliPrintf("ch       : _DEF_UART%d, %d bps, %s\n", modbus.ch + 1, modbus.baud, modbus.is_open ? "open":"close");
+    cliPrintf("id       : %d\n", modbus.id);
+    cliPrintf("t3.5     : %d bits\n", modbus.t35_bits);
+    cliPrintf("rx frame : %d (other id %d)\n", modbus.rx_frame, modbus.rx_other);
+    cliPrintf("tx frame : %d\n", modbus.tx_frame);
+    cliPrintf("crc err  : %d\n", modbus.crc_err);
+    cliPrintf("len err  : %d\n", modbus.len_err);
+    cliPrintf("ex       : %d\n", modbus.ex_cnt);
+    ret = true;
+  }
+
+  if (args->argc == 3 && args->isStr(0, "reg"))
+  {
+    uint16_t addr;
+    uint16_t count;
+
+    addr  = constrain(args->getData(1), 0, HW_MODBUS_REG_MAX - 1);
+    count = constrain(args->getData(2), 1, HW_MODBUS_REG_MAX - addr);
+
+    for (int i=0; i<count; i++)
+    {
+      cliPrintf("%04d : 0x%04X (%d)\n", addr + i, modbus_reg[addr + i], modbus_reg[addr + i]);
+    }
+    ret = true;
+  }
+
+  if (args->argc == 3 && args->isStr(0, "write"))
+  {
+    uint16_t addr;
+    uint16_t data;
+
+    addr = constrain(args->getData(1), 0, HW_MODBUS_REG_MAX - 1);
+    data = args->getData(2);
+
+    modbus_reg[addr] = data;
+    cliPrintf("%04d : 0x%04X (%d)\n", addr, modbus_reg[addr], modbus_reg[addr]);
+    ret = true;
+  }
+
+  if (ret == false)
+  {
+    cliPrintf("modbus info\n");
+    cliPrintf("modbus reg addr[0~%d] count\n", HW_MODBUS_REG_MAX - 1);
+    cliPrintf("modbus write addr[0~%d] data\n", HW_MODBUS_REG_MAX - 1);
+  }
+}
+#endif
+
+#endif
@@ -0,0 +1,340 @@
+#include "packet.h"
+#include "uart.h"
+#include "slip.h"
+#include "cli.h"
+
+
+#ifdef _USE_HW_PACKET
+
+
+#define PACKET_TX_CHUNK_MAX     64
+
+
+typedef struct
+{
+  bool       is_open;
+  uint8_t    uart_ch;
+
+  slip_enc_t enc;
+  bool       is_begin;
+  uint32_t   tx_len;
+  uint8_t    tx_chunk[PACKET_TX_CHUNK_MAX];
+  uint32_t   tx_packet;
+  uint32_t   tx_data;       // 보낸 데이터 바이트
+  uint32_t   tx_wire;       // 선로에 나간 바이트 (프레임/ESC/CRC 포함)
+
+  slip_dec_t dec;
+  uint8_t    rx_buf[PACKET_DATA_MAX + SLIP_CRC_SIZE];
+} packet_t;
+
+
+#ifdef _USE_HW_CLI
+static void cliPacket(cli_args_t *args);
+#endif
+static bool packetFlushChunk(packet_t *p_packet);
+
+
+static packet_t packet_tbl[PACKET_MAX_CH];
+
+
+
+
+bool packetInit(void)
+{
+  for (int i=0; i<PACKET_MAX_CH; i++)
+  {
+    packet_tbl[i].is_open   = false;
+    packet_tbl[i].uart_ch   = 0;
+    packet_tbl[i].is_begin  = false;
+    packet_tbl[i].tx_len    = 0;
+    packet_tbl[i].tx_packet = 0;
+    packet_tbl[i].tx_data   = 0;
+    packet_tbl[i].tx_wire   = 0;
+
+    slipDecodeInit(&packet_tbl[i].dec, packet_tbl[i].rx_buf, sizeof(packet_tbl[i].rx_buf));
+  }
+
+#ifdef _USE_HW_CLI
+  cliAdd("packet", cliPacket);
+#endif
+
+  return true;
+}
+
+bool packetOpen(uint8_t ch, uint8_t uart_ch, uint32_t baud)
+{
+  packet_t *p_packet;
+
+
+  if (ch >= PACKET_MAX_CH) return false;
+
+  p_packet = &packet_tbl[ch];
+
+  p_packet->uart_ch  = uart_ch;
+  p_packet->is_begin = false;
+  p_packet->tx_len   = 0;
+  slipDecodeReset(&p_packet->dec);
+
+  p_packet->is_open = uartOpen(uart_ch, baud);
+
+  return p_packet->is_open;
+}
+
+bool packetIsOpen(uint8_t ch)
+{
+  if (ch >= PACKET_MAX_CH) return false;
+
+  return packet_tbl[ch].is_open;
+}
+
+bool packetFlushChunk(packet_t *p_packet)
+{
+  uint32_t len;
+
+
+  if (p_packet->tx_len == 0)
+  {
+    return true;
+  }
+
+  len = uartWrite(p_packet->uart_ch, p_packet->tx_chunk, p_packet->tx_len);
+  p_packet->tx_wire += len;
+
+  if (len != p_packet->tx_len)
+  {
+    p_packet->tx_len = 0;
+    return false;
+  }
+  p_packet->tx_len = 0;
+
+  return true;
+}
+
+// 패킷 데이터는 작은 조각 단위로 인코딩해 TX 링에 바로 넣는다.
+// 전체 프레임을 따로 버퍼링하지 않으므로 패킷 길이에 제한이 없다.
+//
+bool packetBegin(uint8_t ch)
+{
+  packet_t *p_packet;
+
+
+  if (ch >= PACKET_MAX_CH) return false;
+  if (packet_tbl[ch].is_open != true) return false;
+
+  p_packet = &packet_tbl[ch];
+
+  p_packet->tx_len   = slipEncodeBegin(&p_packet->enc, p_packet->tx_chunk);
+  p_packet->is_begin = true;
+
+  return true;
+}
+
+bool packetWriteData(uint8_t ch, const uint8_t *p_data, uint32_t length)
+{
+  packet_t *p_packet;
+  bool ret = true;
+
+
+  if (ch >= PACKET_MAX_CH) return false;
+  if (packet_tbl[ch].is_begin != true) return false;
+
+  p_packet = &packet_tbl[ch];
+
+  for (uint32_t i=0; i<length; i++)
+  {
+    if (p_packet->tx_len + SLIP_ENCODE_BYTE_MAX > PACKET_TX_CHUNK_MAX)
+    {
+      ret &= packetFlushChunk(p_packet);
+    }
+    p_packet->tx_len += slipEncodeByte(&p_packet->enc, p_data[i], &p_packet->tx_chunk[p_packet->tx_len]);
+  }
+  p_packet->tx_data += length;
+
+  return ret;
+}
+
+bool packetEnd(uint8_t ch)
+{
+  packet_t *p_packet;
+  bool ret = true;
+
+
+  if (ch >= PACKET_MAX_CH) return false;
+  if (packet_tbl[ch].is_begin != true) return false;
+
+  p_packet = &packet_tbl[ch];
+
+  if (p_packet->tx_len + SLIP_ENCODE_END_MAX > PACKET_TX_CHUNK_MAX)
+  {
+    ret &= packetFlushChunk(p_packet);
+  }
+  p_packet->tx_len += slipEncodeEnd(&p_packet->enc, &p_packet->tx_chunk[p_packet->tx_len]);
+  ret &= packetFlushChunk(p_packet);
+
+  p_packet->is_begin = false;
+  p_packet->tx_packet++;
+
+  return ret;
+}
+
+bool packetSend(uint8_t ch, const uint8_t *p_data, uint32_t length)
+{
+  bool ret;
+
+
+  ret  = packetBegin(ch);
+  ret &= packetWriteData(ch, p_data, length);
+  ret &= packetEnd(ch);
+
+  return ret;
+}
+
+// RX 링을 복사 없이 읽어 디코딩하고, 프레임이 완성되면 거기서 멈춘다.
+// 남은 바이트는 링에 그대로 두었다가 다음 호출에서 이어서 처리한다.
+//
+bool packetReceive(uint8_t ch)
+{
+  packet_t *p_packet;
+  uint8_t  *p_data;
+  uint32_t  span;
+  uint32_t  i;
+
+
+  if (ch >= PACKET_MAX_CH) return false;
+  if (packet_tbl[ch].is_open != true) return false;
+
+  p_packet = &packet_tbl[ch];
+
+  while((span = uartPeekRx(p_packet->uart_ch, &p_data)) > 0)
+  {
+    for (i=0; i<span; i++)
+    {
+      if (slipDecodeByte(&p_packet->dec, p_data[i]) == true)
+      {
+        uartConsumeRx(p_packet->uart_ch, i + 1);
+        return true;
+      }
+    }
+    uartConsumeRx(p_packet->uart_ch, span);
+  }
+
+  return false;
+}
+
+// packetReceive() 가 true 일 때 받은 데이터, 다음 packetReceive() 전까지 유효
+//
+uint32_t packetGetData(uint8_t ch, uint8_t **p_data)
+{
+  if (ch >= PACKET_MAX_CH) return 0;
+
+  *p_data = packet_tbl[ch].rx_buf;
+
+  return packet_tbl[ch].dec.length;
+}
+
+
+#ifdef _USE_HW_CLI
+void cliPacket(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    for (int i=0; i<PACKET_MAX_CH; i++)
+    {
+      packet_t *p_packet = &packet_tbl[i];
+
+      cliPrintf("ch%d : %s, _DEF_UART%d\n", i, p_packet->is_open ? "open":"close", p_packet->uart_ch + 1);
+      cliPrintf("  tx  : %d packets, data %d, wire %d bytes\n", p_packet->tx_packet, p_packet->tx_data, p_packet->tx_wire);
+      cliPrintf("  rx  : %d packets\n", p_packet->dec.frame_cnt);
+      cliPrintf("  err : crc %d, len %d, esc %d\n", p_packet->dec.crc_err, p_packet->dec.len_err, p_packet->dec.esc_err);
+    }
+    ret = true;
+  }
+
+  // UART 없이 인코더 출력을 디코더에 넣어 되돌아오는지 확인한다.
+  //
+  if (args->argc == 2 && args->isStr(0, "loop"))
+  {
+    slip_enc_t enc;
+    slip_dec_t dec;
+    uint8_t    tx_buf[PACKET_DATA_MAX];
+    uint8_t    rx_buf[PACKET_DATA_MAX + SLIP_CRC_SIZE];
+    uint8_t    wire[SLIP_ENCODE_END_MAX];
+    uint32_t   count;
+    uint32_t   pass = 0;
+    uint32_t   data_total = 0;
+    uint32_t   wire_total = 0;
+
+    count = args->getData(1);
+    slipDecodeInit(&dec, rx_buf, sizeof(rx_buf));
+
+    for (uint32_t n=0; n<count; n++)
+    {
+      uint32_t length;
+      uint32_t w_len;
+      bool     is_done = false;
+
+      // END/ESC 가 자주 나오도록 그 값을 섞는다.
+      //
+      length = 1 + rand() % PACKET_DATA_MAX;
+      for (uint32_t i=0; i<length; i++)
+      {
+        uint32_t r = rand() % 8;
+
+        tx_buf[i] = (r == 0) ? SLIP_END : (r == 1) ? SLIP_ESC : rand();
+      }
+
+      w_len = slipEncodeBegin(&enc, wire);
+      for (uint32_t i=0; i<w_len; i++) slipDecodeByte(&dec, wire[i]);
+      wire_total += w_len;
+
+      for (uint32_t i=0; i<length; i++)
+      {
+        w_len = slipEncodeByte(&enc, tx_buf[i], wire);
+        for (uint32_t j=0; j<w_len; j++) slipDecodeByte(&dec, wire[j]);
+        wire_total += w_len;
+      }
+
+      w_len = slipEncodeEnd(&enc, wire);
+      for (uint32_t i=0; i<w_len; i++)
+      {
+        is_done |= slipDecodeByte(&dec, wire[i]);
+      }
+      wire_total += w_len;
+      data_total += length;
+
+      if (is_done == true && dec.length == length && memcmp(tx_buf, rx_buf, length) == 0)
+      {
+        pass++;
+      }
+    }
+
+    cliPrintf("loop : %d/%d pass, data %d, wire %d bytes\n", pass, count, data_total, wire_total);
+    cliPrintf("err  : crc %d, len %d, esc %d\n", dec.crc_err, dec.len_err, dec.esc_err);
+    ret = true;
+  }
+
+  if (args->argc == 3 && args->isStr(0, "send"))
+  {
+    uint8_t ch;
+    char   *p_str;
+
+    ch    = constrain(args->getData(1), 0, PACKET_MAX_CH - 1);
+    p_str = args->getStr(2);
+
+    cliPrintf("send : %s\n", packetSend(ch, (uint8_t *)p_str, strlen(p_str)) ? "OK":"Fail");
+    ret = true;
+  }
+
+  if (ret == false)
+  {
+    cliPrintf("packet info\n");
+    cliPrintf("packet loop count\n");
+    cliPrintf("packet send ch[0~%d] str\n", PACKET_MAX_CH - 1);
+  }
+}
+#endif
+
+#endif
@@ -10,37 +10,111 @@
 #ifdef _USE_HW_UART
 
 
-#define UART_RX_BUF_LENGTH        1024
+#define UART1_RX_BUF_LENGTH       1024
+#define UART1_TX_BUF_LENGTH       1024
+#define UART2_RX_BUF_LENGTH       512
+#define UART2_TX_BUF_LENGTH       512
+#define UART3_RX_BUF_LENGTH       1024
+#define UART3_TX_BUF_LENGTH       512
+#define UART_TX_TIMEOUT           100
+#define UART_BAUD_ERR_OVER16      100     // 16배 오버샘플링을 유지할 최대 오차 (0.01% 단위)
+#define UART_AUTO_BAUD_INIT       115200  // 자동 속도 검출 전 초기 속도
+#define UART_AUTO_BAUD_MODE       UART_ADVFEATURE_AUTOBAUDRATE_ONSTARTBIT
+#define UART_RTS_MARGIN           64      // RTS 를 올린 뒤에도 상대가 더 보낼 수 있는 바이트 (USB-UART FIFO 등)
 #define MAX_BUF_SIZE              100
+#define UART_BENCH_CHUNK          64      // uart bench tx 한 번에 쓰는 크기
+#define UART_BENCH_RTT_MAX        256     // uart bench rtt 최대 샘플 수
+#define UART_BENCH_RTT_TIMEOUT    100     // ms
 
 
+typedef enum {
+	UART_TYPE_NORMAL,
+	UART_TYPE_RS485,
+	UART_TYPE_LIN
+} uart_type_t;
+
 typedef struct
 {
   bool is_open;
   uint32_t baud;
+  uint32_t baud_real;           // BRR 로 실제 설정된 속도
+  int32_t  baud_err;            // 요청 대비 오차 (0.01% 단위)
+  volatile bool baud_locked;    // 자동 속도 검출 완료
 
-  uint8_t  rx_buf[UART_RX_BUF_LENGTH];
   qbuffer_t qbuffer;
   UART_HandleTypeDef *p_huart;
   DMA_HandleTypeDef  *p_hdma_rx;
+  DMA_HandleTypeDef  *p_hdma_tx;
+
+  qbuffer_t qbuffer_tx;
+  volatile bool     tx_busy;
+  volatile uint32_t tx_len;     // 현재 DMA 로 전송 중인 길이
 
   uint32_t rx_cnt;
   uint32_t tx_cnt;
-} uart_tbl_t;
 
-typedef enum {
-	UART_TYPE_NORMAL,
-	UART_TYPE_RS485,
-	UART_TYPE_LIN
-} uart_type_t;
+  volatile uint8_t rx_event;
+  void (*rx_func)(uint8_t ch, uint8_t event);
+
+  // 순환 DMA 추월 검출
+  //
+  volatile uint32_t rx_total;   // DMA 가 기록한 누적 바이트 (ISR)
+  volatile uint32_t rx_read;    // 소비자가 읽은 누적 바이트
+  volatile uint32_t rx_valid;   // 유효한 데이터가 시작되는 누적 위치 (ISR)
+  volatile bool     rx_resync;  // 소비자가 rx_valid 로 다시 맞춰야 함
+  uint8_t           rx_ovr_policy;
+
+  volatile bool     rts_stop;   // RTS 로 상대 송신을 멈춘 상태
+
+  // RS485
+  //
+  uint8_t           de_assert;    // DE 시간 (1/16 비트 단위)
+  uint8_t           de_deassert;
+  volatile bool     de_wait_rx;   // 송신 완료 후 응답 대기 중
+  volatile uint32_t de_tx_end;    // 송신 완료 시점 (DWT 사이클)
+  volatile uint32_t de_tx_total;  // 송신 완료 시점의 rx_total
+  uint32_t          turn_min_us;  // 측정된 최소 턴어라운드
+  uint32_t          turn_last_us;
+
+  // LIN
+  //
+  uart_type_t       uart_type;    // 기본은 uart_hw_tbl, _USE_HW_LIN 이면 HW_LIN_CH 는 LIN
+  void (*lin_break_func)(uint8_t ch);
+
+  // 수신 타임아웃 (RTO)
+  //
+  uint32_t          rto_bits;
+  void (*rto_func)(uint8_t ch);
+
+  // 문자 일치 (CMF)
+  //
+  uint8_t           match_char;
+  void (*match_func)(uint8_t ch);
+
+  // 채널을 쓰는 드라이버 (modbus, lin), 인터럽트에서 링을 읽고 쓰므로 다른 곳에서 쓰면 안 된다.
+  //
+  const char       *p_owner;
+
+  uart_err_t err;
+} uart_tbl_t;
 
 typedef struct
 {
   const char         *p_msg;
   USART_TypeDef      *p_uart;
+  uint32_t            clk_sel;      // RCC_PERIPHCLK_xx, 커널 클럭 조회용
   UART_HandleTypeDef *p_huart;
   DMA_HandleTypeDef  *p_hdma_rx;
-  DMA_HandleTypeDef  *p_hdma_tx;
+  DMA_HandleTypeDef  *p_hdma_tx;   // NULL 이면 폴링 송신
+  uint8_t            *p_rx_buf;
+  uint32_t            rx_buf_len;
+  uint8_t            *p_tx_buf;
+  uint32_t            tx_buf_len;
+  uint32_t            hw_flow;      // UART_HWCONTROL_NONE/CTS, TX 의 CTS 는 하드웨어가 처리
+  GPIO_TypeDef       *p_rts_port;   // NULL 이면 RTS 없음, 있으면 수신 링 점유율로 제어
+  uint16_t            rts_pin;
+  uint8_t             de_assert;    // RS485 DE 기본 시간 (1/16 비트 단위)
+  uint8_t             de_deassert;
   uart_type_t        uart_type;
 } uart_hw_t;
 
@@ -48,7 +122,20 @@ typedef struct
 
 #ifdef _USE_HW_CLI
 static void cliUart(cli_args_t *args);
+static void uartBench(uint8_t ch, const char *p_mode, uint32_t param);
 #endif
+static bool uartRxStart(uint8_t ch);
+static bool uartSetOverSampling(uint8_t ch, uint32_t baud);
+static void uartUpdateBaudReal(uint8_t ch);
+static void uartAutoBaudCheck(uint8_t ch);
+static void uartRtsUpdate(uint8_t ch);
+static void uartRtsResume(uint8_t ch);
+static uint32_t uartDeSamples(uint8_t ch, uint8_t time);
+static void uartDeMeasure(uint8_t ch, uint8_t event);
+static void uartRxCheck(uint8_t ch);
+static void uartRxUpdateIn(uint8_t ch, uint32_t pos);
+static void uartTxStart(uint8_t ch);
+static void uartTxPolling(uint8_t ch);
 
 
 static bool is_init = false;
@@ -56,34 +143,93 @@ static bool is_init = false;
 __attribute__((section(".non_cache")))
 static uart_tbl_t uart_tbl[UART_MAX_CH];
 
+__attribute__((section(".non_cache")))
+static uint8_t uart1_rx_buf[UART1_RX_BUF_LENGTH];
+__attribute__((section(".non_cache")))
+static uint8_t uart1_tx_buf[UART1_TX_BUF_LENGTH];
+__attribute__((section(".non_cache")))
+static uint8_t uart2_rx_buf[UART2_RX_BUF_LENGTH];
+__attribute__((section(".non_cache")))
+static uint8_t uart2_tx_buf[UART2_TX_BUF_LENGTH];
+__attribute__((section(".non_cache")))
+static uint8_t uart3_rx_buf[UART3_RX_BUF_LENGTH];
+__attribute__((section(".non_cache")))
+static uint8_t uart3_tx_buf[UART3_TX_BUF_LENGTH];
+
 extern UART_HandleTypeDef huart1;
+extern UART_HandleTypeDef huart2;
+extern UART_HandleTypeDef huart3;
 extern DMA_HandleTypeDef hdma_usart1_rx;
-
-const static uart_hw_t uart_hw_tbl[UART_MAX_CH] =
+extern DMA_HandleTypeDef hdma_usart1_tx;
+extern DMA_HandleTypeDef hdma_usart2_rx;
+extern DMA_HandleTypeDef hdma_usart2_tx;
+extern DMA_HandleTypeDef hdma_usart3_rx;
+extern DMA_HandleTypeDef hdma_usart3_tx;
+
+// 채널 추가는 이 테이블에 한 줄 넣고 HW_UART_MAX_CH 를 올리면 된다.
+// 수신은 순환 DMA 가 필수이고, 송신 DMA 가 없으면 폴링으로 보낸다.
+//
+const static uart_hw_t uart_hw_tbl[] =
 {
-  {"USART1   DEBUG   ", USART1,   &huart1,    &hdma_usart1_rx,  NULL, UART_TYPE_NORMAL}
+  {"USART1   DEBUG   ", USART1,   RCC_PERIPHCLK_USART1, &huart1,    &hdma_usart1_rx,  &hdma_usart1_tx, uart1_rx_buf, UART1_RX_BUF_LENGTH, uart1_tx_buf, UART1_TX_BUF_LENGTH, UART_HWCONTROL_NONE, NULL,                0,             0,  0,  UART_TYPE_NORMAL},
+  {"USART2   FIELD   ", USART2,   RCC_PERIPHCLK_USART2, &huart2,    &hdma_usart2_rx,  &hdma_usart2_tx, uart2_rx_buf, UART2_RX_BUF_LENGTH, uart2_tx_buf, UART2_TX_BUF_LENGTH, UART_HWCONTROL_NONE, NULL,                0,             16, 16, UART_TYPE_RS485},
+  {"USART3   MODEM   ", USART3,   RCC_PERIPHCLK_USART3, &huart3,    &hdma_usart3_rx,  &hdma_usart3_tx, uart3_rx_buf, UART3_RX_BUF_LENGTH, uart3_tx_buf, UART3_TX_BUF_LENGTH, UART_HWCONTROL_CTS,  UART3_RTS_GPIO_Port, UART3_RTS_Pin, 0,  0,  UART_TYPE_NORMAL},
 };
 
+_Static_assert(sizeof(uart_hw_tbl)/sizeof(uart_hw_t) >= UART_MAX_CH, "uart_hw_tbl has fewer entries than HW_UART_MAX_CH");
+
 bool uartInit(void)
 {
   for (int i=0; i<UART_MAX_CH; i++)
   {
-    uart_tbl[i].is_open = false;
-
-    switch (i)
-    {
-      case HW_UART_CH_DEBUG:
-        uart_tbl[i].baud = 115200;
-        if(uart_hw_tbl[i].uart_type == UART_TYPE_RS485)
-        {
-        	//	RS485 Disable
-        	//HAL_GPIO_WritePin(RS485_DE_GPIO_Port, RS485_DE_Pin, GPIO_PIN_SET);
-        }
-        break;
-    }
+    uart_tbl[i].is_open   = false;
+    uart_tbl[i].baud      = 115200;
+    uart_tbl[i].baud_real = 0;
+    uart_tbl[i].baud_err  = 0;
+    uart_tbl[i].baud_locked = false;
+    uart_tbl[i].p_huart   = uart_hw_tbl[i].p_huart;
+    uart_tbl[i].p_hdma_rx = uart_hw_tbl[i].p_hdma_rx;
+    uart_tbl[i].p_hdma_tx = uart_hw_tbl[i].p_hdma_tx;
 
     uart_tbl[i].rx_cnt = 0;
     uart_tbl[i].tx_cnt = 0;
+
+    uart_tbl[i].rx_event  = 0;
+    uart_tbl[i].rx_func   = NULL;
+    uart_tbl[i].rx_ovr_policy = UART_RX_OVR_NEWEST;
+    uart_tbl[i].rts_stop  = false;
+
+    uart_tbl[i].uart_type = uart_hw_tbl[i].uart_type;
+#ifdef _USE_HW_LIN
+    if (i == HW_LIN_CH)
+    {
+      uart_tbl[i].uart_type = UART_TYPE_LIN;
+    }
+#endif
+    uart_tbl[i].lin_break_func = NULL;
+    uart_tbl[i].rto_bits = 0;
+    uart_tbl[i].rto_func = NULL;
+    uart_tbl[i].match_char = 0;
+    uart_tbl[i].match_func = NULL;
+    uart_tbl[i].p_owner    = NULL;
+
+    uart_tbl[i].de_assert    = uart_hw_tbl[i].de_assert;
+    uart_tbl[i].de_deassert  = uart_hw_tbl[i].de_deassert;
+    uart_tbl[i].de_wait_rx   = false;
+    uart_tbl[i].turn_min_us  = UINT32_MAX;
+    uart_tbl[i].turn_last_us = 0;
+    memset(&uart_tbl[i].err, 0, sizeof(uart_err_t));
+
+    uart_tbl[i].rx_total  = 0;
+    uart_tbl[i].rx_read   = 0;
+    uart_tbl[i].rx_valid  = 0;
+    uart_tbl[i].rx_resync = false;
+    qbufferCreate(&uart_tbl[i].qbuffer, uart_hw_tbl[i].p_rx_buf, uart_hw_tbl[i].rx_buf_len);
+    qbufferRegister(&uart_tbl[i].qbuffer, uart_hw_tbl[i].p_msg);
+
+    uart_tbl[i].tx_busy   = false;
+    uart_tbl[i].tx_len    = 0;
+    qbufferCreate(&uart_tbl[i].qbuffer_tx, uart_hw_tbl[i].p_tx_buf, uart_hw_tbl[i].tx_buf_len);
   }
 
   is_init = true;
@@ -109,275 +255,1472 @@ bool uartOpen(uint8_t ch, uint32_t baud)
 {
   bool ret = false;
   HAL_StatusTypeDef ret_hal;
+  uint32_t init_baud;
 
   if (ch >= UART_MAX_CH) return false;
 
-  if (uart_tbl[ch].is_open == true && uart_tbl[ch].baud == baud)
+  // 자동 속도 검출은 다시 요청하면 항상 새로 시작한다. (재검출)
+  //
+  if (uart_tbl[ch].is_open == true && uart_tbl[ch].baud == baud && baud != UART_BAUD_AUTO)
   {
     return true;
   }
 
+  // 자동 속도 검출은 초기 속도로 열어 두고, 호스트가 보낸 첫 문자의 시작 비트로 속도를 맞춘다.
+  // 첫 문자는 LSB 가 1 이어야 한다. (CR, 'U' 등)
+  // 열려 있는 포트의 상태는 요청을 검사한 뒤에 바꾼다.
+  //
+  init_baud = baud;
+  if (baud == UART_BAUD_AUTO)
+  {
+    if (!IS_USART_AUTOBAUDRATE_DETECTION_INSTANCE(uart_hw_tbl[ch].p_uart))
+    {
+      return false;
+    }
+    init_baud = UART_AUTO_BAUD_INIT;
+  }
 
-  switch(ch)
+  if (uartSetOverSampling(ch, init_baud) != true)
   {
-    case HW_UART_CH_DEBUG:
-      uart_tbl[ch].baud      = baud;
-      uart_tbl[ch].p_huart   = uart_hw_tbl[ch].p_huart;
-      uart_tbl[ch].p_hdma_rx = uart_hw_tbl[ch].p_hdma_rx;
-      uart_tbl[ch].p_huart->Instance = uart_hw_tbl[ch].p_uart;
+    return false;
+  }
 
-      uart_tbl[ch].p_huart->Init.BaudRate       = baud;
-      uart_tbl[ch].p_huart->Init.WordLength     = UART_WORDLENGTH_8B;
-      uart_tbl[ch].p_huart->Init.StopBits       = UART_STOPBITS_1;
-      uart_tbl[ch].p_huart->Init.Parity         = UART_PARITY_NONE;
-      uart_tbl[ch].p_huart->Init.Mode           = UART_MODE_TX_RX;
-      uart_tbl[ch].p_huart->Init.HwFlowCtl      = UART_HWCONTROL_NONE;
-      uart_tbl[ch].p_huart->Init.OverSampling   = UART_OVERSAMPLING_16;
-      uart_tbl[ch].p_huart->Init.OneBitSampling = UART_ONE_BIT_SAMPLE_DISABLE;
-      uart_tbl[ch].p_huart->AdvancedInit.AdvFeatureInit = UART_ADVFEATURE_NO_INIT;
+  uart_tbl[ch].baud = baud;
+  uart_tbl[ch].baud_locked = false;
+  uart_tbl[ch].p_huart->Instance = uart_hw_tbl[ch].p_uart;
 
-      qbufferCreate(&uart_tbl[ch].qbuffer, &uart_tbl[ch].rx_buf[0], UART_RX_BUF_LENGTH);
+  uart_tbl[ch].p_huart->Init.BaudRate       = init_baud;
+  uart_tbl[ch].p_huart->Init.WordLength     = UART_WORDLENGTH_8B;
+  uart_tbl[ch].p_huart->Init.StopBits       = UART_STOPBITS_1;
+  uart_tbl[ch].p_huart->Init.Parity         = UART_PARITY_NONE;
+  uart_tbl[ch].p_huart->Init.Mode           = UART_MODE_TX_RX;
+  uart_tbl[ch].p_huart->Init.HwFlowCtl      = uart_hw_tbl[ch].hw_flow;
+  uart_tbl[ch].p_huart->AdvancedInit.AdvFeatureInit = UART_ADVFEATURE_NO_INIT;
 
-      __HAL_RCC_DMA1_CLK_ENABLE();
+  if (baud == UART_BAUD_AUTO)
+  {
+    uart_tbl[ch].p_huart->Init.OverSampling            = UART_OVERSAMPLING_16;
+    uart_tbl[ch].p_huart->Init.OneBitSampling          = UART_ONE_BIT_SAMPLE_DISABLE;
+    uart_tbl[ch].p_huart->AdvancedInit.AdvFeatureInit  = UART_ADVFEATURE_AUTOBAUDRATE_INIT;
+    uart_tbl[ch].p_huart->AdvancedInit.AutoBaudRateEnable = UART_ADVFEATURE_AUTOBAUDRATE_ENABLE;
+    uart_tbl[ch].p_huart->AdvancedInit.AutoBaudRateMode   = UART_AUTO_BAUD_MODE;
+  }
 
-      HAL_UART_DeInit(uart_tbl[ch].p_huart);
+  uartFlushTx(ch);
+  uart_tbl[ch].is_open = false;
+  HAL_UART_DeInit(uart_tbl[ch].p_huart);
 
-      if(uart_hw_tbl[ch].uart_type == UART_TYPE_RS485)
-      {
-        ret_hal = HAL_RS485Ex_Init(uart_tbl[ch].p_huart, UART_DE_POLARITY_HIGH, 0, 0);
-      }
-      else if(uart_hw_tbl[ch].uart_type == UART_TYPE_LIN)
-      {
-    	  ret_hal = HAL_LIN_Init(uart_tbl[ch].p_huart, UART_LINBREAKDETECTLENGTH_11B);
-      }
-      else
-      {
-        ret_hal = HAL_UART_Init(uart_tbl[ch].p_huart);
-      }
+  if(uart_tbl[ch].uart_type == UART_TYPE_RS485)
+  {
+    ret_hal = HAL_RS485Ex_Init(uart_tbl[ch].p_huart,
+                               UART_DE_POLARITY_HIGH,
+                               uartDeSamples(ch, uart_tbl[ch].de_assert),
+                               uartDeSamples(ch, uart_tbl[ch].de_deassert));
+  }
+  else if(uart_tbl[ch].uart_type == UART_TYPE_LIN)
+  {
+    ret_hal = HAL_LIN_Init(uart_tbl[ch].p_huart, UART_LINBREAKDETECTLENGTH_11B);
+  }
+  else
+  {
+    ret_hal = HAL_UART_Init(uart_tbl[ch].p_huart);
+  }
 
-      if (ret_hal == HAL_OK)
-      {
-        ret = true;
-        uart_tbl[ch].is_open = true;
+  if (ret_hal == HAL_OK)
+  {
+    uart_tbl[ch].is_open = true;
+    uartUpdateBaudReal(ch);
 
-        if(HAL_UART_Receive_DMA(uart_tbl[ch].p_huart, (uint8_t *)&uart_tbl[ch].rx_buf[0], UART_RX_BUF_LENGTH) != HAL_OK)
-        {
-          ret = false;
-        }
+    if (uart_tbl[ch].uart_type == UART_TYPE_LIN && uart_tbl[ch].lin_break_func != NULL)
+    {
+      __HAL_UART_ENABLE_IT(uart_tbl[ch].p_huart, UART_IT_LBD);
+    }
+    if (uart_tbl[ch].rto_func != NULL)
+    {
+      uartSetRxTimeout(ch, uart_tbl[ch].rto_bits, uart_tbl[ch].rto_func);
+    }
 
-        uart_tbl[ch].qbuffer.in  = uart_tbl[ch].qbuffer.len - ((DMA_Channel_TypeDef *)uart_tbl[ch].p_huart->hdmarx->Instance)->CNDTR;
-        uart_tbl[ch].qbuffer.out = uart_tbl[ch].qbuffer.in;
-      }
-      break;
+    // 문자 일치(ADD)는 UE=0 일 때만 쓸 수 있으므로 수신 DMA 를 시작하기 전에 설정한다.
+    //
+    __HAL_UART_DISABLE(uart_tbl[ch].p_huart);
+    MODIFY_REG(uart_tbl[ch].p_huart->Instance->CR2, USART_CR2_ADD | USART_CR2_ADDM7,
+               ((uint32_t)uart_tbl[ch].match_char << USART_CR2_ADD_Pos) | USART_CR2_ADDM7);
+    __HAL_UART_ENABLE(uart_tbl[ch].p_huart);
+    if (uart_tbl[ch].match_func != NULL)
+    {
+      __HAL_UART_CLEAR_FLAG(uart_tbl[ch].p_huart, UART_CLEAR_CMF);
+      __HAL_UART_ENABLE_IT(uart_tbl[ch].p_huart, UART_IT_CM);
+    }
+
+    ret = uartRxStart(ch);
+
+    uart_tbl[ch].qbuffer.out = uart_tbl[ch].qbuffer.in;
+    uart_tbl[ch].rx_total    = 0;
+    uart_tbl[ch].rx_read     = 0;
+    uart_tbl[ch].rx_valid    = 0;
+    uart_tbl[ch].rx_resync   = false;
+
+    uart_tbl[ch].de_wait_rx   = false;
+    uart_tbl[ch].turn_min_us  = UINT32_MAX;
+    uart_tbl[ch].turn_last_us = 0;
+
+    if (uart_hw_tbl[ch].p_rts_port != NULL)
+    {
+      uart_tbl[ch].rts_stop = false;
+      HAL_GPIO_WritePin(uart_hw_tbl[ch].p_rts_port, uart_hw_tbl[ch].rts_pin, GPIO_PIN_RESET);
+    }
   }
 
   return ret;
 }
 
-bool uartClose(uint8_t ch)
+// 요청 속도에 맞는 오버샘플링을 고른다.
+// 오차가 UART_BAUD_ERR_OVER16 이내면 잡음에 강한 16배를 쓰고, 아니면 오차가 작은 쪽을 쓴다.
+// 8배일 때는 클럭 편차 허용폭을 넓히기 위해 1비트 샘플링을 켠다.
+// (80MHz 에서 16배는 5Mbps, 8배는 10Mbps 까지)
+//
+bool uartSetOverSampling(uint8_t ch, uint32_t baud)
 {
-  if (ch >= UART_MAX_CH) return false;
+  uint32_t clk;
+  uint32_t div;
+  uint32_t err_16 = UINT32_MAX;
+  uint32_t err_8  = UINT32_MAX;
 
-  if(uart_hw_tbl[ch].uart_type == UART_TYPE_LIN)
+
+  clk = HAL_RCCEx_GetPeriphCLKFreq(uart_hw_tbl[ch].clk_sel);
+  if (clk == 0 || baud == 0)
   {
+    return false;
   }
 
-  uart_tbl[ch].is_open = false;
+  div = (clk + baud/2) / baud;
+  if (div >= 16 && div <= 0xFFFF)
+  {
+    err_16 = abs((int32_t)(clk / div) - (int32_t)baud);
+  }
+
+  div = (2*clk + baud/2) / baud;
+  if (div >= 16 && div <= 0xFFFF)
+  {
+    err_8 = abs((int32_t)(2*clk / div) - (int32_t)baud);
+  }
+
+  if (err_16 == UINT32_MAX && err_8 == UINT32_MAX)
+  {
+    return false;
+  }
+
+  // LIN 모드는 16배 오버샘플링만 된다.
+  //
+  if (uart_tbl[ch].uart_type == UART_TYPE_LIN)
+  {
+    if (err_16 == UINT32_MAX)
+    {
+      return false;
+    }
+    err_8 = UINT32_MAX;
+  }
+
+  if (err_16 <= err_8 || (uint64_t)err_16 * 10000 <= (uint64_t)baud * UART_BAUD_ERR_OVER16)
+  {
+    uart_tbl[ch].p_huart->Init.OverSampling   = UART_OVERSAMPLING_16;
+    uart_tbl[ch].p_huart->Init.OneBitSampling = UART_ONE_BIT_SAMPLE_DISABLE;
+  }
+  else
+  {
+    uart_tbl[ch].p_huart->Init.OverSampling   = UART_OVERSAMPLING_8;
+    uart_tbl[ch].p_huart->Init.OneBitSampling = UART_ONE_BIT_SAMPLE_ENABLE;
+  }
 
   return true;
 }
 
-uint32_t uartAvailable(uint8_t ch)
+// HAL 이 설정한 BRR 을 읽어 실제 속도와 오차를 계산한다.
+//
+void uartUpdateBaudReal(uint8_t ch)
 {
-  uint32_t ret = 0;
+  uint32_t clk;
+  uint32_t brr;
+  uint32_t div;
+
+
+  clk = HAL_RCCEx_GetPeriphCLKFreq(uart_hw_tbl[ch].clk_sel);
+  brr = uart_tbl[ch].p_huart->Instance->BRR;
 
-  switch(ch)
+  if (uart_tbl[ch].p_huart->Init.OverSampling == UART_OVERSAMPLING_8)
   {
-    case HW_UART_CH_DEBUG:
-    {
-      uart_tbl[ch].qbuffer.in = (uart_tbl[ch].qbuffer.len - ((DMA_Channel_TypeDef *)uart_tbl[ch].p_hdma_rx->Instance)->CNDTR);
-      ret = qbufferAvailable(&uart_tbl[ch].qbuffer);
-    }
-    break;
+    div = (brr & 0xFFF0) | ((brr & 0x0007) << 1);
+    clk = 2*clk;
+  }
+  else
+  {
+    div = brr;
   }
 
-  return ret;
+  if (div == 0)
+  {
+    uart_tbl[ch].baud_real = 0;
+    uart_tbl[ch].baud_err  = 0;
+    return;
+  }
+
+  uart_tbl[ch].baud_real = (clk + div/2) / div;
+
+  if (uart_tbl[ch].baud == UART_BAUD_AUTO)
+    uart_tbl[ch].baud_err = 0;
+  else
+    uart_tbl[ch].baud_err = (int32_t)(((int64_t)uart_tbl[ch].baud_real - uart_tbl[ch].baud) * 10000 / uart_tbl[ch].baud);
 }
 
-bool uartIsOpen(uint8_t ch)
+// 수신 이벤트마다 자동 속도 검출 결과를 확인한다.
+// 검출 실패(ABRE)면 그 문자는 버리고 다음 문자로 다시 검출한다.
+//
+void uartAutoBaudCheck(uint8_t ch)
 {
-  bool ret = false;
+  UART_HandleTypeDef *p_huart = uart_tbl[ch].p_huart;
+
 
-  switch(ch)
+  if (uart_tbl[ch].baud != UART_BAUD_AUTO || uart_tbl[ch].baud_locked == true)
   {
-    case HW_UART_CH_DEBUG:
-      ret = uart_tbl[ch].is_open = true;
-      break;
+    return;
+  }
+
+  if (__HAL_UART_GET_FLAG(p_huart, UART_FLAG_ABRE))
+  {
+    uart_tbl[ch].err.abr++;
+    uart_tbl[ch].rx_valid  = uart_tbl[ch].rx_total;
+    uart_tbl[ch].rx_resync = true;
+    __HAL_UART_SEND_REQ(p_huart, UART_AUTOBAUD_REQUEST);
+  }
+  else if (__HAL_UART_GET_FLAG(p_huart, UART_FLAG_ABRF))
+  {
+    uartUpdateBaudReal(ch);
+    uart_tbl[ch].baud_locked = true;
   }
-  return ret;
 }
 
-bool uartFlush(uint8_t ch)
+bool uartIsBaudLocked(uint8_t ch)
 {
-  uint32_t pre_time;
+  if (ch >= UART_MAX_CH) return false;
 
+  if (uart_tbl[ch].baud != UART_BAUD_AUTO)
+    return uart_tbl[ch].is_open;
 
-  pre_time = millis();
-  while(uartAvailable(ch))
+  return uart_tbl[ch].baud_locked;
+}
+
+// 순환 DMA 수신을 시작한다.
+// DMA HT/TC 와 USART IDLE 인터럽트에서 HAL_UARTEx_RxEventCallback() 이 불리고,
+// 그때 DMA 위치를 qbuffer 의 in 으로 공개한다.
+//
+bool uartRxStart(uint8_t ch)
+{
+  if(HAL_UARTEx_ReceiveToIdle_DMA(uart_tbl[ch].p_huart, uart_hw_tbl[ch].p_rx_buf, uart_hw_tbl[ch].rx_buf_len) != HAL_OK)
   {
-    if (millis()-pre_time >= 10)
-    {
-      break;
-    }
-    uartRead(ch);
+    return false;
   }
 
+  uart_tbl[ch].qbuffer.in = (uart_tbl[ch].qbuffer.len - ((DMA_Channel_TypeDef *)uart_tbl[ch].p_huart->hdmarx->Instance)->CNDTR) % uart_tbl[ch].qbuffer.len;
+
   return true;
 }
 
-uint8_t uartRead(uint8_t ch)
+// DE 시간(1/16 비트)을 오버샘플링 단위로 바꾼다. 레지스터는 5비트라 31 이 최대
+// (16배면 약 2비트, 8배면 약 4비트)
+//
+uint32_t uartDeSamples(uint8_t ch, uint8_t time)
 {
-  uint8_t ret = 0;
+  uint32_t ret = time;
+
+  if (uart_tbl[ch].p_huart->Init.OverSampling == UART_OVERSAMPLING_8)
+  {
+    ret = (ret + 1) / 2;
+  }
+
+  return cmin(ret, 31);
+}
+
+// DE 시간을 바꾸면 USART 를 다시 열어 적용한다.
+//
+bool uartSetDeTime(uint8_t ch, uint8_t assert_time, uint8_t deassert_time)
+{
+  if (ch >= UART_MAX_CH) return false;
+  if (uart_tbl[ch].uart_type != UART_TYPE_RS485) return false;
 
+  uart_tbl[ch].de_assert   = assert_time;
+  uart_tbl[ch].de_deassert = deassert_time;
 
-  switch(ch)
+  if (uart_tbl[ch].is_open == true)
   {
-    case HW_UART_CH_DEBUG:
-      qbufferRead(&uart_tbl[ch].qbuffer, &ret, 1);
-      break;
+    uart_tbl[ch].is_open = false;
+    return uartOpen(ch, uart_tbl[ch].baud);
   }
-  uart_tbl[ch].rx_cnt++;
 
-  return ret;
+  return true;
 }
 
-bool uartLinSendBreak(uint8_t ch)
+// 송신 완료(TC, 마지막 정지 비트 끝)부터 슬레이브 응답의 첫 시작 비트까지의 시간
+// DMA 수신이라 첫 바이트 시점은 알 수 없으므로, 이벤트 시점에서 받은 바이트 수만큼
+// 문자 시간을 빼서 구한다. IDLE 이벤트는 마지막 바이트 뒤 1 문자 후에 온다.
+//
+void uartDeMeasure(uint8_t ch, uint8_t event)
 {
-   bool ret = false;
+  uint32_t now = DWT->CYCCNT;
+  uint32_t rx_len;
+  uint32_t char_cycles;
+  uint32_t elapsed;
+  uint32_t back;
+  uint32_t turn_us;
+
 
-  switch(ch)
+  if (uart_tbl[ch].baud_real == 0)
   {
-  case HW_UART_CH_DEBUG:
-      if (HAL_LIN_SendBreak(uart_tbl[ch].p_huart) == HAL_OK)
-      {
-        ret = true;
-      }
-      break;
+    uart_tbl[ch].de_wait_rx = false;
+    return;
   }
 
-  return ret;
+  rx_len = uart_tbl[ch].rx_total - uart_tbl[ch].de_tx_total;
+  if (event & UART_RX_EVENT_IDLE)
+  {
+    rx_len += 1;
+  }
+
+  char_cycles = (uint32_t)((uint64_t)SystemCoreClock * 10 / uart_tbl[ch].baud_real);
+  elapsed     = now - uart_tbl[ch].de_tx_end;
+  back        = rx_len * char_cycles;
+
+  turn_us = (elapsed > back ? elapsed - back : 0) / (SystemCoreClock / 1000000);
+
+  uart_tbl[ch].turn_last_us = turn_us;
+  uart_tbl[ch].turn_min_us  = cmin(uart_tbl[ch].turn_min_us, turn_us);
+  uart_tbl[ch].de_wait_rx   = false;
 }
 
+bool uartGetTurnaround(uint8_t ch, uint32_t *p_min_us, uint32_t *p_last_us)
+{
+  if (ch >= UART_MAX_CH) return false;
+  if (uart_tbl[ch].turn_min_us == UINT32_MAX) return false;
 
-uint32_t uartWrite(uint8_t ch, uint8_t *p_data, uint32_t length)
+  *p_min_us  = uart_tbl[ch].turn_min_us;
+  *p_last_us = uart_tbl[ch].turn_last_us;
+
+  return true;
+}
+
+// RTS 는 하드웨어 RTS 대신 GPIO 로 직접 제어한다.
+// 하드웨어 RTS 는 RDR 기준이라 DMA 가 바로 비워 주면 링버퍼가 차도 내려가지 않는다.
+// 점유율은 DMA HT/TC 마다(버퍼 절반) 확인하므로, 다음 이벤트까지 절반이 더 들어와도
+// 넘치지 않도록 절반에서 UART_RTS_MARGIN 을 뺀 지점에서 멈추고 1/4 이하로 줄면 다시 받는다.
+//
+void uartRtsUpdate(uint8_t ch)
 {
-  uint32_t ret = 0;
+  uint32_t len = uart_tbl[ch].qbuffer.len;
+  uint32_t unread;
 
 
-  switch(ch)
+  if (uart_hw_tbl[ch].p_rts_port == NULL)
   {
-      case HW_UART_CH_DEBUG:
-      if (HAL_UART_Transmit(uart_tbl[ch].p_huart, p_data, length, 100) == HAL_OK)
-      {
-        ret = length;
-      }
-      break;
+    return;
   }
-  uart_tbl[ch].tx_cnt += ret;
 
-  return ret;
+  unread = uart_tbl[ch].rx_total - uart_tbl[ch].rx_read;
+
+  if (uart_tbl[ch].rts_stop != true && unread + UART_RTS_MARGIN >= len/2)
+  {
+    uart_tbl[ch].rts_stop = true;
+    HAL_GPIO_WritePin(uart_hw_tbl[ch].p_rts_port, uart_hw_tbl[ch].rts_pin, GPIO_PIN_SET);
+  }
+  else if (uart_tbl[ch].rts_stop == true && unread <= len/4)
+  {
+    uart_tbl[ch].rts_stop = false;
+    HAL_GPIO_WritePin(uart_hw_tbl[ch].p_rts_port, uart_hw_tbl[ch].rts_pin, GPIO_PIN_RESET);
+  }
 }
 
-uint32_t uartPrintf(uint8_t ch, const char *fmt, ...)
+// 소비자 쪽에서 읽은 뒤 호출, 멈춘 상태일 때만 인터럽트를 막고 확인한다.
+//
+void uartRtsResume(uint8_t ch)
 {
-  char buf[256];
-  va_list args;
-  int len;
-  uint32_t ret;
+  if (uart_tbl[ch].rts_stop != true)
+  {
+    return;
+  }
 
-  va_start(args, fmt);
-  len = vsnprintf(buf, 256, fmt, args);
+  __disable_irq();
+  uartRtsUpdate(ch);
+  __enable_irq();
+}
 
-  ret = uartWrite(ch, (uint8_t *)buf, len);
+// 소비자 쪽에서 호출, 추월이나 수신 재시작이 있었으면 out 을 유효한 데이터로 옮긴다.
+//
+void uartRxCheck(uint8_t ch)
+{
+  qbuffer_t *p_q = &uart_tbl[ch].qbuffer;
+  uint32_t keep;
 
-  va_end(args);
 
+  if (uart_tbl[ch].rx_resync != true)
+  {
+    return;
+  }
 
-  return ret;
+  __disable_irq();
+  uart_tbl[ch].rx_resync = false;
+
+  keep = cmin(uart_tbl[ch].rx_total - uart_tbl[ch].rx_valid, p_q->len - 1);
+  p_q->out = (p_q->in + p_q->len - keep) % p_q->len;
+  uart_tbl[ch].rx_read = uart_tbl[ch].rx_total - keep;
+  __enable_irq();
 }
 
-uint32_t uartGetBaud(uint8_t ch)
+bool uartSetRxOverrunPolicy(uint8_t ch, uint8_t policy)
 {
-  uint32_t ret = 0;
+  if (ch >= UART_MAX_CH) return false;
 
+  uart_tbl[ch].rx_ovr_policy = policy;
 
-  if (ch >= UART_MAX_CH)
-    return 0;
+  return true;
+}
 
-  ret = uart_tbl[ch].baud;
+bool uartGetErr(uint8_t ch, uart_err_t *p_err)
+{
+  if (ch >= UART_MAX_CH) return false;
 
-  return ret;
+  *p_err = uart_tbl[ch].err;
+
+  return true;
 }
 
-uint32_t uartGetRxCnt(uint8_t ch)
+bool uartClose(uint8_t ch)
 {
-  if (ch >= UART_MAX_CH) return 0;
+  if (ch >= UART_MAX_CH) return false;
 
-  return uart_tbl[ch].rx_cnt;
+  if(uart_tbl[ch].uart_type == UART_TYPE_LIN)
+  {
+    __HAL_UART_DISABLE_IT(uart_tbl[ch].p_huart, UART_IT_LBD);
+  }
+
+  uart_tbl[ch].is_open = false;
+
+  return true;
 }
 
-uint32_t uartGetTxCnt(uint8_t ch)
+uint32_t uartAvailable(uint8_t ch)
 {
   if (ch >= UART_MAX_CH) return 0;
 
-  return uart_tbl[ch].tx_cnt;
+  uartRxCheck(ch);
+
+  return qbufferAvailable(&uart_tbl[ch].qbuffer);
 }
 
-#ifdef _USE_HW_CLI
-void cliUart(cli_args_t *args)
+// 수신 데이터가 생길 때까지 timeout(ms) 동안 WFI 로 잠든다.
+//
+uint32_t uartWaitAvailable(uint8_t ch, uint32_t timeout)
 {
-  bool ret = false;
+  uint32_t pre_time;
 
 
-  if (args->argc == 1 && args->isStr(0, "info"))
+  if (ch >= UART_MAX_CH) return 0;
+
+  pre_time = millis();
+  while(uartAvailable(ch) == 0)
   {
-    for (int i=0; i<UART_MAX_CH; i++)
+    if (millis()-pre_time >= timeout)
     {
-      cliPrintf("_DEF_UART%d : %s, %d bps\n", i+1, uart_hw_tbl[i].p_msg, uartGetBaud(i));
+      break;
     }
-    ret = true;
+    __WFI();
   }
 
-  if (args->argc == 2 && args->isStr(0, "test"))
-  {
-    uint8_t uart_ch;
+  return uartAvailable(ch);
+}
 
-    uart_ch = constrain(args->getData(1), 1, UART_MAX_CH) - 1;
+// 수신 이벤트(UART_RX_EVENT_xx)를 읽고 지운다.
+//
+uint8_t uartGetRxEvent(uint8_t ch)
+{
+  uint8_t ret;
 
-    if (uart_ch != cliGetPort())
-    {
-      uint8_t rx_data;
 
-      while(1)
-      {
-        if (uartAvailable(uart_ch) > 0)
-        {
-          rx_data = uartRead(uart_ch);
-          cliPrintf("<- _DEF_UART%d RX : 0x%X\n", uart_ch + 1, rx_data);
-        }
+  if (ch >= UART_MAX_CH) return 0;
 
-        if (cliAvailable() > 0)
-        {
-          rx_data = cliRead();
-          if (rx_data == 'q')
-          {
-            break;
-          }
-          else
-          {
-            uartWrite(uart_ch, &rx_data, 1);
-            cliPrintf("-> _DEF_UART%d TX : 0x%X\n", uart_ch + 1, rx_data);
-          }
+  __disable_irq();
+  ret = uart_tbl[ch].rx_event;
+  uart_tbl[ch].rx_event = 0;
+  __enable_irq();
+
+  return ret;
+}
+
+bool uartSetRxCallback(uint8_t ch, void (*p_func)(uint8_t ch, uint8_t event))
+{
+  if (ch >= UART_MAX_CH) return false;
+
+  uart_tbl[ch].rx_func = p_func;
+
+  return true;
+}
+
+bool uartIsOpen(uint8_t ch)
+{
+  if (ch >= UART_MAX_CH) return false;
+
+  return uart_tbl[ch].is_open;
+}
+
+bool uartFlush(uint8_t ch)
+{
+  uint32_t pre_time;
+  uint8_t *p_data;
+
+
+  pre_time = millis();
+  while(uartAvailable(ch))
+  {
+    if (millis()-pre_time >= 10)
+    {
+      break;
+    }
+    uartConsumeRx(ch, uartPeekRx(ch, &p_data));
+  }
+
+  return true;
+}
+
+uint8_t uartRead(uint8_t ch)
+{
+  uint8_t ret = 0;
+
+
+  if (ch >= UART_MAX_CH) return 0;
+
+  uartRxCheck(ch);
+  if (qbufferRead(&uart_tbl[ch].qbuffer, &ret, 1) == true)
+  {
+    uart_tbl[ch].rx_read++;
+    uartRtsResume(ch);
+  }
+  uart_tbl[ch].rx_cnt++;
+
+  return ret;
+}
+
+// 수신된 데이터를 최대 length 만큼 한 번에 복사한다. (memcpy 최대 2회)
+//
+uint32_t uartReadBuf(uint8_t ch, uint8_t *p_data, uint32_t length)
+{
+  uint32_t ret = 0;
+
+
+  if (ch >= UART_MAX_CH) return 0;
+
+  uartRxCheck(ch);
+  ret = cmin(length, qbufferAvailable(&uart_tbl[ch].qbuffer));
+  qbufferRead(&uart_tbl[ch].qbuffer, p_data, ret);
+  uart_tbl[ch].rx_read += ret;
+  uart_tbl[ch].rx_cnt  += ret;
+  uartRtsResume(ch);
+
+  return ret;
+}
+
+// 수신 버퍼 안의 연속된 데이터 위치와 길이를 돌려준다. (복사 없음)
+// 처리한 만큼 uartConsumeRx() 로 반납한다.
+//
+uint32_t uartPeekRx(uint8_t ch, uint8_t **p_data)
+{
+  if (ch >= UART_MAX_CH) return 0;
+
+  uartRxCheck(ch);
+
+  return qbufferSpanRead(&uart_tbl[ch].qbuffer, p_data);
+}
+
+void uartConsumeRx(uint8_t ch, uint32_t length)
+{
+  if (ch >= UART_MAX_CH) return;
+
+  length = cmin(length, qbufferAvailable(&uart_tbl[ch].qbuffer));
+  qbufferConsume(&uart_tbl[ch].qbuffer, length);
+  uart_tbl[ch].rx_read += length;
+  uart_tbl[ch].rx_cnt  += length;
+  uartRtsResume(ch);
+}
+
+bool uartLinSendBreak(uint8_t ch)
+{
+  bool ret = false;
+
+
+  if (ch >= UART_MAX_CH) return false;
+
+  if (HAL_LIN_SendBreak(uart_tbl[ch].p_huart) == HAL_OK)
+  {
+    ret = true;
+  }
+
+  return ret;
+}
+
+// LIN 브레이크 검출(LBD) 인터럽트를 켜고 검출 시 호출할 함수를 등록한다.
+//
+bool uartLinSetBreakCallback(uint8_t ch, void (*p_func)(uint8_t ch))
+{
+  if (ch >= UART_MAX_CH) return false;
+  if (uart_tbl[ch].uart_type != UART_TYPE_LIN) return false;
+
+  uart_tbl[ch].lin_break_func = p_func;
+
+  if (uart_tbl[ch].is_open == true)
+  {
+    __HAL_UART_CLEAR_FLAG(uart_tbl[ch].p_huart, UART_CLEAR_LBDF);
+    if (p_func != NULL)
+      __HAL_UART_ENABLE_IT(uart_tbl[ch].p_huart, UART_IT_LBD);
+    else
+      __HAL_UART_DISABLE_IT(uart_tbl[ch].p_huart, UART_IT_LBD);
+  }
+
+  return true;
+}
+
+// 마지막 수신 문자 뒤 bits 비트 시간 동안 수신이 없으면 p_func 를 인터럽트에서 호출한다.
+// (bits 가 0 이거나 p_func 가 NULL 이면 끈다)
+//
+bool uartSetRxTimeout(uint8_t ch, uint32_t bits, void (*p_func)(uint8_t ch))
+{
+  UART_HandleTypeDef *p_huart;
+
+
+  if (ch >= UART_MAX_CH) return false;
+  if (IS_LPUART_INSTANCE(uart_hw_tbl[ch].p_uart)) return false;      // LPUART 는 RTO 없음
+
+  p_huart = uart_tbl[ch].p_huart;
+
+  uart_tbl[ch].rto_bits = cmin(bits, USART_RTOR_RTO);
+  uart_tbl[ch].rto_func = (bits > 0) ? p_func : NULL;
+
+  if (uart_tbl[ch].is_open != true)
+  {
+    return true;
+  }
+
+  if (uart_tbl[ch].rto_func != NULL)
+  {
+    HAL_UART_ReceiverTimeout_Config(p_huart, uart_tbl[ch].rto_bits);
+    __HAL_UART_CLEAR_FLAG(p_huart, UART_CLEAR_RTOF);
+    SET_BIT(p_huart->Instance->CR2, USART_CR2_RTOEN);
+    __HAL_UART_ENABLE_IT(p_huart, UART_IT_RTO);
+  }
+  else
+  {
+    __HAL_UART_DISABLE_IT(p_huart, UART_IT_RTO);
+    CLEAR_BIT(p_huart->Instance->CR2, USART_CR2_RTOEN);
+  }
+
+  return true;
+}
+
+// 수신한 문자가 c 와 같으면 p_func 를 인터럽트에서 호출한다. (p_func 가 NULL 이면 끈다)
+// 비교는 USART 가 RDR 에 문자가 들어올 때 하므로 DMA 수신과 같이 쓸 수 있다.
+// ADD 필드는 UE 가 0 일 때만 쓸 수 있으므로 잠시 USART 를 멈춘다.
+//
+bool uartSetMatchChar(uint8_t ch, uint8_t c, void (*p_func)(uint8_t ch))
+{
+  UART_HandleTypeDef *p_huart;
+
+
+  if (ch >= UART_MAX_CH) return false;
+
+  p_huart = uart_tbl[ch].p_huart;
+
+  uart_tbl[ch].match_char = c;
+  uart_tbl[ch].match_func = p_func;
+
+  if (uart_tbl[ch].is_open != true)
+  {
+    return true;
+  }
+
+  // ADD 는 UE=0 일 때만 쓸 수 있다. 동작 중인 DMA 를 끊지 않도록
+  // 문자가 바뀌었으면 포트를 다시 열어 uartOpen() 에서 설정한다.
+  //
+  if (p_func != NULL && (READ_BIT(p_huart->Instance->CR2, USART_CR2_ADD) >> USART_CR2_ADD_Pos) != c)
+  {
+    uart_tbl[ch].is_open = false;
+    return uartOpen(ch, uart_tbl[ch].baud);
+  }
+
+  if (p_func != NULL)
+  {
+    __HAL_UART_CLEAR_FLAG(p_huart, UART_CLEAR_CMF);
+    __HAL_UART_ENABLE_IT(p_huart, UART_IT_CM);
+  }
+  else
+  {
+    __HAL_UART_DISABLE_IT(p_huart, UART_IT_CM);
+  }
+
+  return true;
+}
+
+// 인터럽트에서 RX/TX 링을 직접 쓰는 드라이버가 채널을 차지한다. NULL 이면 해제
+// qbuffer 는 생산자/소비자가 하나씩이므로 CLI 시험 명령은 차지된 채널을 쓰지 않는다.
+//
+bool uartSetOwner(uint8_t ch, const char *p_owner)
+{
+  if (ch >= UART_MAX_CH) return false;
+
+  if (p_owner != NULL && uart_tbl[ch].p_owner != NULL && strcmp(uart_tbl[ch].p_owner, p_owner) != 0)
+  {
+    return false;
+  }
+  uart_tbl[ch].p_owner = p_owner;
+
+  return true;
+}
+
+const char *uartGetOwner(uint8_t ch)
+{
+  if (ch >= UART_MAX_CH) return NULL;
+
+  return uart_tbl[ch].p_owner;
+}
+
+// HAL 이 처리하지 않는 인터럽트(LBD, RTO, CMF)를 먼저 처리한다. USARTx_IRQHandler() 에서 HAL 보다 먼저 호출
+// HAL 은 RTO 를 수신 에러로 보고 DMA 수신을 중단하므로 여기서 플래그를 지운다.
+//
+void uartIRQHandler(UART_HandleTypeDef *huart)
+{
+  for (int i=0; i<UART_MAX_CH; i++)
+  {
+    if (uart_tbl[i].p_huart == huart)
+    {
+      if (uart_tbl[i].uart_type == UART_TYPE_LIN && __HAL_UART_GET_FLAG(huart, UART_FLAG_LBDF))
+      {
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_LBDF);
+        if (uart_tbl[i].lin_break_func != NULL)
+        {
+          uart_tbl[i].lin_break_func(i);
+        }
+      }
+      if (__HAL_UART_GET_FLAG(huart, UART_FLAG_RTOF))
+      {
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_RTOF);
+        if (uart_tbl[i].rto_func != NULL)
+        {
+          uart_tbl[i].rto_func(i);
+        }
+      }
+      if (__HAL_UART_GET_FLAG(huart, UART_FLAG_CMF) && __HAL_UART_GET_IT_SOURCE(huart, UART_IT_CM))
+      {
+        uint32_t timeout = 100;
+
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_CMF);
+
+        // 일치한 문자는 IDLE 이벤트(1 문자 뒤)가 와야 링에 공개되므로,
+        // DMA 가 RDR 을 가져가길 기다린 뒤 카운터 위치까지 바로 공개한다.
+        //
+        while(__HAL_UART_GET_FLAG(huart, UART_FLAG_RXNE) && timeout-- > 0);
+        if (huart->hdmarx != NULL)
+        {
+          uartRxUpdateIn(i, uart_tbl[i].qbuffer.len - __HAL_DMA_GET_COUNTER(huart->hdmarx));
+        }
+        uart_tbl[i].rx_event |= UART_RX_EVENT_MATCH;
+        if (uart_tbl[i].match_func != NULL)
+        {
+          uart_tbl[i].match_func(i);
+        }
+      }
+      break;
+    }
+  }
+}
+
+
+// 기다리지 않고 바로 쓸 수 있는 TX 링버퍼 크기
+//
+uint32_t uartAvailableForWrite(uint8_t ch)
+{
+  if (ch >= UART_MAX_CH) return 0;
+  if (uart_tbl[ch].p_hdma_tx == NULL) return UINT32_MAX;
+
+  return qbufferAvailableForWrite(&uart_tbl[ch].qbuffer_tx);
+}
+
+uint32_t uartWrite(uint8_t ch, uint8_t *p_data, uint32_t length)
+{
+  uint32_t ret = 0;
+  uint32_t pre_time;
+
+
+  if (ch >= UART_MAX_CH) return 0;
+
+  if (uart_tbl[ch].p_hdma_tx == NULL)
+  {
+    if (HAL_UART_Transmit(uart_tbl[ch].p_huart, p_data, length, UART_TX_TIMEOUT) == HAL_OK)
+    {
+      ret = length;
+    }
+    uart_tbl[ch].tx_cnt += ret;
+    return ret;
+  }
+
+  // TX 링버퍼에 넣고 바로 리턴, 전송은 DMA 가 완료 인터럽트에서 이어서 한다.
+  // 링버퍼가 가득 찬 경우에만 자리가 날 때까지 UART_TX_TIMEOUT 동안 기다린다.
+  //
+  pre_time = millis();
+  while(ret < length)
+  {
+    uint32_t w_len;
+
+    w_len = cmin(length - ret, qbufferAvailableForWrite(&uart_tbl[ch].qbuffer_tx));
+    if (w_len > 0)
+    {
+      qbufferWrite(&uart_tbl[ch].qbuffer_tx, &p_data[ret], w_len);
+      ret += w_len;
+      pre_time = millis();
+    }
+    uartTxStart(ch);
+
+    if (millis()-pre_time >= UART_TX_TIMEOUT)
+    {
+      break;
+    }
+    if (ret < length && (__get_PRIMASK() != 0 || __get_IPSR() != 0))
+    {
+      // 인터럽트가 막혀 있으면 DMA 완료가 오지 않으므로 직접 내보낸다.
+      uartTxPolling(ch);
+    }
+  }
+  uart_tbl[ch].tx_cnt += ret;
+
+  return ret;
+}
+
+// 링버퍼에서 이어진 구간을 그대로 DMA 로 보낸다.
+// 메인 루프와 인터럽트(완료 콜백, modbus/lin 응답)가 모두 호출하므로 tx_busy 확인부터
+// DMA 시작까지는 인터럽트를 막고 처리한다. 시작에 실패하면 tx_busy 를 건드리지 않는다.
+//
+void uartTxStart(uint8_t ch)
+{
+  uint8_t *p_buf;
+  uint32_t length;
+  uint32_t primask;
+
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if (uart_tbl[ch].tx_busy != true)
+  {
+    length = qbufferSpanRead(&uart_tbl[ch].qbuffer_tx, &p_buf);
+    if (length > 0 && HAL_UART_Transmit_DMA(uart_tbl[ch].p_huart, p_buf, length) == HAL_OK)
+    {
+      uart_tbl[ch].tx_len  = length;
+      uart_tbl[ch].tx_busy = true;
+    }
+  }
+
+  __set_PRIMASK(primask);
+}
+
+// 진행 중인 DMA 를 멈추고 남은 데이터를 폴링으로 전송한다.
+// DMA 를 먼저 멈춘 뒤 CNDTR 을 읽어야 그 사이에 나간 바이트를 다시 보내지 않는다.
+//
+void uartTxPolling(uint8_t ch)
+{
+  uint8_t *p_buf;
+  uint32_t length;
+  uint32_t primask;
+
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if (uart_tbl[ch].tx_busy == true)
+  {
+    uint32_t sent;
+
+    HAL_UART_AbortTransmit(uart_tbl[ch].p_huart);
+    sent = uart_tbl[ch].tx_len - ((DMA_Channel_TypeDef *)uart_tbl[ch].p_hdma_tx->Instance)->CNDTR;
+    qbufferConsume(&uart_tbl[ch].qbuffer_tx, sent);
+
+    uart_tbl[ch].tx_len  = 0;
+    uart_tbl[ch].tx_busy = false;
+  }
+
+  __set_PRIMASK(primask);
+
+  while((length = qbufferSpanRead(&uart_tbl[ch].qbuffer_tx, &p_buf)) > 0)
+  {
+    if (HAL_UART_Transmit(uart_tbl[ch].p_huart, p_buf, length, UART_TX_TIMEOUT) != HAL_OK)
+    {
+      qbufferFlush(&uart_tbl[ch].qbuffer_tx);
+      break;
+    }
+    qbufferConsume(&uart_tbl[ch].qbuffer_tx, length);
+  }
+}
+
+// TX 링버퍼가 모두 전송될 때까지 기다린다.
+// Fault 처리처럼 인터럽트가 막힌 상황에서는 폴링으로 직접 전송한다.
+//
+bool uartFlushTx(uint8_t ch)
+{
+  uint32_t pre_time;
+
+
+  if (ch >= UART_MAX_CH) return false;
+  if (uart_tbl[ch].p_hdma_tx == NULL) return true;
+
+  if (__get_PRIMASK() != 0 || __get_IPSR() != 0)
+  {
+    uartTxPolling(ch);
+    return true;
+  }
+
+  pre_time = millis();
+  while(uart_tbl[ch].tx_busy == true || qbufferAvailable(&uart_tbl[ch].qbuffer_tx) > 0)
+  {
+    uartTxStart(ch);
+    if (millis()-pre_time >= UART_TX_TIMEOUT)
+    {
+      uartTxPolling(ch);
+      break;
+    }
+  }
+
+  return true;
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  for (int i=0; i<UART_MAX_CH; i++)
+  {
+    if (uart_tbl[i].p_huart == huart && uart_tbl[i].tx_busy == true)
+    {
+      qbufferConsume(&uart_tbl[i].qbuffer_tx, uart_tbl[i].tx_len);
+      uart_tbl[i].tx_len  = 0;
+      uart_tbl[i].tx_busy = false;
+
+      // 보낼 데이터가 더 없으면 DE 가 내려가고 응답을 기다린다.
+      //
+      if (uart_tbl[i].uart_type == UART_TYPE_RS485 && qbufferAvailable(&uart_tbl[i].qbuffer_tx) == 0)
+      {
+        uart_tbl[i].de_tx_end   = DWT->CYCCNT;
+        uart_tbl[i].de_tx_total = uart_tbl[i].rx_total;
+        uart_tbl[i].de_wait_rx  = true;
+      }
+
+      uartTxStart(i);
+      break;
+    }
+  }
+}
+
+// DMA 가 기록한 위치(pos)까지를 수신 링에 공개하고 누적 수신 바이트를 더한다.
+// RX 이벤트 콜백과 문자 일치 인터럽트(같은 우선순위)에서 호출한다.
+//
+void uartRxUpdateIn(uint8_t ch, uint32_t pos)
+{
+  qbuffer_t *p_q = &uart_tbl[ch].qbuffer;
+
+  uart_tbl[ch].rx_total += (pos + p_q->len - p_q->in) % p_q->len;
+  qbufferUpdateIn(p_q, pos);
+}
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+  for (int i=0; i<UART_MAX_CH; i++)
+  {
+    if (uart_tbl[i].p_huart == huart)
+    {
+      qbuffer_t *p_q = &uart_tbl[i].qbuffer;
+      uint8_t event;
+      uint32_t pos;
+
+      // Size 는 DMA 가 기록한 버퍼 위치
+      // HT/TC 는 반 바퀴마다 오므로 이전 위치와의 차이가 곧 새로 받은 바이트 수
+      //
+      pos = (Size >= p_q->len) ? 0 : Size;
+      uartRxUpdateIn(i, pos);
+      uartAutoBaudCheck(i);
+
+      if (HAL_UARTEx_GetRxEventType(huart) == HAL_UART_RXEVENT_IDLE)
+        event = UART_RX_EVENT_IDLE;
+      else
+        event = UART_RX_EVENT_DATA;
+
+      // 읽지 않은 데이터가 버퍼 크기를 넘으면 DMA 가 소비자를 추월한 것
+      //
+      if (uart_tbl[i].rx_total - uart_tbl[i].rx_read > p_q->len - 1 && uart_tbl[i].rx_resync != true)
+      {
+        uart_tbl[i].err.rx_overrun++;
+
+        if (uart_tbl[i].rx_ovr_policy == UART_RX_OVR_NEWEST)
+          uart_tbl[i].rx_valid = uart_tbl[i].rx_total - (p_q->len - 1);
+        else
+          uart_tbl[i].rx_valid = uart_tbl[i].rx_total;
+        uart_tbl[i].rx_resync = true;
+
+        event |= UART_RX_EVENT_OVERRUN;
+      }
+
+      uartRtsUpdate(i);
+
+      if (uart_tbl[i].de_wait_rx == true && uart_tbl[i].rx_total != uart_tbl[i].de_tx_total)
+      {
+        uartDeMeasure(i, event);
+      }
+
+      uart_tbl[i].rx_event |= event;
+      if (uart_tbl[i].rx_func != NULL)
+      {
+        uart_tbl[i].rx_func(i, event);
+      }
+      break;
+    }
+  }
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  for (int i=0; i<UART_MAX_CH; i++)
+  {
+    if (uart_tbl[i].p_huart == huart && uart_tbl[i].is_open == true)
+    {
+      uint32_t err_code = huart->ErrorCode;
+
+      if (err_code & HAL_UART_ERROR_ORE) uart_tbl[i].err.ore++;
+      if (err_code & HAL_UART_ERROR_FE)  uart_tbl[i].err.fe++;
+      if (err_code & HAL_UART_ERROR_NE)  uart_tbl[i].err.ne++;
+      if (err_code & HAL_UART_ERROR_PE)  uart_tbl[i].err.pe++;
+
+      // DMA 수신 중 에러가 나면 HAL 이 수신을 중단하므로 다시 시작한다.
+      // DMA 는 버퍼 처음부터 다시 쓰므로 이전에 받은 데이터는 버린다.
+      //
+      if (huart->RxState == HAL_UART_STATE_READY)
+      {
+        uart_tbl[i].rx_valid  = uart_tbl[i].rx_total;
+        uart_tbl[i].rx_resync = true;
+        uart_tbl[i].err.restart++;
+
+        uartRxStart(i);
+      }
+      break;
+    }
+  }
+}
+
+uint32_t uartPrintf(uint8_t ch, const char *fmt, ...)
+{
+  char buf[256];
+  va_list args;
+  int len;
+  uint32_t ret;
+
+  va_start(args, fmt);
+  len = vsnprintf(buf, 256, fmt, args);
+
+  ret = uartWrite(ch, (uint8_t *)buf, len);
+
+  va_end(args);
+
+
+  return ret;
+}
+
+uint32_t uartGetBaud(uint8_t ch)
+{
+  uint32_t ret = 0;
+
+
+  if (ch >= UART_MAX_CH)
+    return 0;
+
+  ret = uart_tbl[ch].baud;
+
+  return ret;
+}
+
+uint32_t uartGetBaudReal(uint8_t ch)
+{
+  if (ch >= UART_MAX_CH) return 0;
+
+  return uart_tbl[ch].baud_real;
+}
+
+int32_t uartGetBaudErr(uint8_t ch)
+{
+  if (ch >= UART_MAX_CH) return 0;
+
+  return uart_tbl[ch].baud_err;
+}
+
+uint32_t uartGetRxCnt(uint8_t ch)
+{
+  if (ch >= UART_MAX_CH) return 0;
+
+  return uart_tbl[ch].rx_cnt;
+}
+
+uint32_t uartGetTxCnt(uint8_t ch)
+{
+  if (ch >= UART_MAX_CH) return 0;
+
+  return uart_tbl[ch].tx_cnt;
+}
+
+#ifdef _USE_HW_CLI
+static bool uartBenchIsQuit(void)
+{
+  return (cliAvailable() > 0 && cliRead() == 'q');
+}
+
+static int uartBenchCompare(const void *p_a, const void *p_b)
+{
+  uint32_t a = *(const uint32_t *)p_a;
+  uint32_t b = *(const uint32_t *)p_b;
+
+  return (a > b) - (a < b);
+}
+
+static void uartBenchPrintRate(uint8_t ch, uint32_t bytes, uint32_t time_ms)
+{
+  uint32_t rate;
+  uint32_t line_max;
+
+
+  rate     = (time_ms > 0) ? (uint32_t)((uint64_t)bytes * 1000 / time_ms) : 0;
+  line_max = uartGetBaudReal(ch) / 10;    // 8N1
+
+  cliPrintf("bytes    : %d\n", bytes);
+  cliPrintf("time     : %d ms\n", time_ms);
+  cliPrintf("rate     : %d B/s (line %d B/s, %d%%)\n", rate, line_max, line_max > 0 ? rate * 100 / line_max : 0);
+}
+
+// 성능 측정, 결과는 "항목 : 값" 형식으로 출력해 호스트 스크립트가 읽을 수 있게 한다.
+// (tools/uart_bench.py 가 CLI 포트로 명령을 보내고 측정 채널의 상대 역할을 한다)
+//
+// tx   : 0,1,2.. 순서 패턴을 param ms 동안 최대 속도로 보낸다.
+// rx   : param ms 동안 받은 순서 패턴의 연속성을 검사한다. (첫 바이트에서 시작)
+// echo : param ms 동안 받은 데이터를 그대로 돌려보낸다. (호스트에서 지연 측정)
+// rtt  : 1 바이트를 보내고 되돌아올 때까지의 시간을 param 회 측정한다. (루프백 또는 호스트 에코)
+//
+void uartBench(uint8_t ch, const char *p_mode, uint32_t param)
+{
+  static uint32_t rtt_buf[UART_BENCH_RTT_MAX];
+  uint8_t  buf[UART_BENCH_CHUNK];
+  uint32_t pre_time;
+  uint32_t bytes = 0;
+  uint32_t err_cnt = 0;
+  uart_err_t err_pre;
+  uart_err_t err_post;
+
+
+  uartGetErr(ch, &err_pre);
+
+  if (strcmp(p_mode, "tx") == 0)
+  {
+    uint8_t seq = 0;
+
+    pre_time = millis();
+    while(millis()-pre_time < param)
+    {
+      for (int i=0; i<UART_BENCH_CHUNK; i++)
+      {
+        buf[i] = seq++;
+      }
+      bytes += uartWrite(ch, buf, UART_BENCH_CHUNK);
+
+      if (uartBenchIsQuit()) break;
+    }
+    uartFlushTx(ch);
+
+    uartBenchPrintRate(ch, bytes, millis()-pre_time);
+  }
+  else if (strcmp(p_mode, "rx") == 0)
+  {
+    uint8_t  seq = 0;
+    uint32_t start_time = 0;
+    uint32_t last_time = 0;
+    uint32_t rx_len;
+
+    uartFlush(ch);
+
+    pre_time = millis();
+    while(millis()-pre_time < param)
+    {
+      rx_len = uartReadBuf(ch, buf, sizeof(buf));
+      if (rx_len > 0)
+      {
+        if (bytes == 0)
+        {
+          start_time = millis();
+          seq = buf[0];
+        }
+        for (uint32_t i=0; i<rx_len; i++)
+        {
+          if (buf[i] != seq)
+          {
+            err_cnt++;
+          }
+          seq = buf[i] + 1;
+        }
+        bytes += rx_len;
+        last_time = millis();
+      }
+
+      if (uartBenchIsQuit()) break;
+    }
+
+    uartBenchPrintRate(ch, bytes, last_time - start_time);
+    cliPrintf("seq err  : %d\n", err_cnt);
+  }
+  else if (strcmp(p_mode, "echo") == 0)
+  {
+    uint32_t rx_len;
+
+    uartFlush(ch);
+
+    pre_time = millis();
+    while(millis()-pre_time < param)
+    {
+      rx_len = uartReadBuf(ch, buf, sizeof(buf));
+      if (rx_len > 0)
+      {
+        bytes += uartWrite(ch, buf, rx_len);
+      }
+
+      if (uartBenchIsQuit()) break;
+    }
+    uartFlushTx(ch);
+
+    cliPrintf("bytes    : %d\n", bytes);
+  }
+  else if (strcmp(p_mode, "rtt") == 0)
+  {
+    uint32_t count;
+    uint32_t cycles_us;
+    uint32_t timeout_cnt = 0;
+
+    count     = constrain(param, 1, UART_BENCH_RTT_MAX);
+    cycles_us = SystemCoreClock / 1000000;
+
+    uartFlush(ch);
+
+    for (uint32_t n=0; n<count; n++)
+    {
+      uint8_t  tx_data = n;
+      uint8_t  rx_data;
+      uint32_t start_cycle;
+      bool     is_rx = false;
+
+      start_cycle = DWT->CYCCNT;
+      uartWrite(ch, &tx_data, 1);
+
+      pre_time = millis();
+      while(millis()-pre_time < UART_BENCH_RTT_TIMEOUT)
+      {
+        if (uartReadBuf(ch, &rx_data, 1) > 0)
+        {
+          is_rx = true;
+          break;
+        }
+      }
+
+      if (is_rx != true)
+      {
+        timeout_cnt++;
+        continue;
+      }
+      if (rx_data != tx_data)
+      {
+        err_cnt++;
+      }
+      rtt_buf[bytes++] = (DWT->CYCCNT - start_cycle) / cycles_us;
+
+      if (uartBenchIsQuit()) break;
+    }
+
+    cliPrintf("samples  : %d\n", bytes);
+    cliPrintf("timeout  : %d\n", timeout_cnt);
+    cliPrintf("seq err  : %d\n", err_cnt);
+    if (bytes > 0)
+    {
+      qsort(rtt_buf, bytes, sizeof(uint32_t), uartBenchCompare);
+
+      cliPrintf("rtt min  : %d us\n", rtt_buf[0]);
+      cliPrintf("rtt p50  : %d us\n", rtt_buf[bytes * 50 / 100]);
+      cliPrintf("rtt p90  : %d us\n", rtt_buf[bytes * 90 / 100]);
+      cliPrintf("rtt p99  : %d us\n", rtt_buf[bytes * 99 / 100]);
+      cliPrintf("rtt max  : %d us\n", rtt_buf[bytes - 1]);
+    }
+  }
+  else
+  {
+    cliPrintf("mode tx|rx|echo|rtt\n");
+    return;
+  }
+
+  uartGetErr(ch, &err_post);
+  cliPrintf("uart err : ovr %d, ore %d, fe %d, ne %d\n",
+            err_post.rx_overrun - err_pre.rx_overrun,
+            err_post.ore - err_pre.ore,
+            err_post.fe - err_pre.fe,
+            err_post.ne - err_pre.ne);
+}
+
+void cliUart(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    for (int i=0; i<UART_MAX_CH; i++)
+    {
+      int32_t err = uartGetBaudErr(i);
+
+      if (uartGetBaud(i) == UART_BAUD_AUTO)
+      {
+        cliPrintf("_DEF_UART%d : %s, auto bps (%s %d)\n",
+                  i+1, uart_hw_tbl[i].p_msg,
+                  uartIsBaudLocked(i) ? "locked":"waiting", uartGetBaudReal(i));
+      }
+      else
+      {
+        cliPrintf("_DEF_UART%d : %s, %d bps (real %d, %c%d.%02d%%, %s)\n",
+                  i+1, uart_hw_tbl[i].p_msg, uartGetBaud(i), uartGetBaudReal(i),
+                  err < 0 ? '-':'+', abs(err)/100, abs(err)%100,
+                  uart_tbl[i].p_huart->Init.OverSampling == UART_OVERSAMPLING_8 ? "OVER8":"OVER16");
+      }
+      cliPrintf("            rx ovr %d, ore %d, fe %d, ne %d, pe %d, restart %d, abr %d\n",
+                uart_tbl[i].err.rx_overrun,
+                uart_tbl[i].err.ore,
+                uart_tbl[i].err.fe,
+                uart_tbl[i].err.ne,
+                uart_tbl[i].err.pe,
+                uart_tbl[i].err.restart,
+                uart_tbl[i].err.abr);
+      if (uart_tbl[i].p_owner != NULL)
+      {
+        cliPrintf("            owner %s\n", uart_tbl[i].p_owner);
+      }
+      if (uart_hw_tbl[i].p_rts_port != NULL)
+      {
+        cliPrintf("            flow rts/cts, rts %s\n", uart_tbl[i].rts_stop ? "stop":"go");
+      }
+      if (uart_tbl[i].uart_type == UART_TYPE_RS485)
+      {
+        uint32_t turn_min, turn_last;
+
+        cliPrintf("            rs485 de %d/%d (1/16 bit)", uart_tbl[i].de_assert, uart_tbl[i].de_deassert);
+        if (uartGetTurnaround(i, &turn_min, &turn_last) == true)
+          cliPrintf(", turn min %d us, last %d us\n", turn_min, turn_last);
+        else
+          cliPrintf(", turn -\n");
+      }
+    }
+    ret = true;
+  }
+
+  if (args->argc == 3 && args->isStr(0, "baud"))
+  {
+    uint8_t  uart_ch;
+    uint32_t baud;
+    bool     ret_open;
+
+    uart_ch = constrain(args->getData(1), 1, UART_MAX_CH) - 1;
+    if (args->isStr(2, "auto"))
+      baud = UART_BAUD_AUTO;
+    else
+      baud    = args->getData(2);
+
+    if (uart_ch == cliGetPort())
+    {
+      if (baud == UART_BAUD_AUTO)
+        cliPrintf("_DEF_UART%d : auto baud, send CR\n", uart_ch + 1);
+      else
+        cliPrintf("_DEF_UART%d : change to %d bps\n", uart_ch + 1, baud);
+      uartFlushTx(uart_ch);
+      ret_open = cliOpen(uart_ch, baud);
+    }
+    else
+    {
+      ret_open = uartOpen(uart_ch, baud);
+    }
+
+    if (ret_open == true && baud == UART_BAUD_AUTO)
+    {
+      if (uartIsBaudLocked(uart_ch) == true)
+        cliPrintf("_DEF_UART%d : auto baud, locked %d bps\n", uart_ch + 1, uartGetBaudReal(uart_ch));
+    }
+    else if (ret_open == true)
+    {
+      int32_t err = uartGetBaudErr(uart_ch);
+
+      cliPrintf("_DEF_UART%d : %d bps, real %d, %c%d.%02d%%\n",
+                uart_ch + 1, baud, uartGetBaudReal(uart_ch),
+                err < 0 ? '-':'+', abs(err)/100, abs(err)%100);
+    }
+    else
+    {
+      cliPrintf("_DEF_UART%d : %d bps Fail\n", uart_ch + 1, baud);
+    }
+    ret = true;
+  }
+
+  if (args->argc == 4 && args->isStr(0, "de"))
+  {
+    uint8_t uart_ch;
+
+    uart_ch = constrain(args->getData(1), 1, UART_MAX_CH) - 1;
+
+    if (uartSetDeTime(uart_ch, constrain(args->getData(2), 0, 255), constrain(args->getData(3), 0, 255)) == true)
+      cliPrintf("_DEF_UART%d : de %d/%d (1/16 bit)\n", uart_ch + 1, uart_tbl[uart_ch].de_assert, uart_tbl[uart_ch].de_deassert);
+    else
+      cliPrintf("_DEF_UART%d : not rs485\n", uart_ch + 1);
+    ret = true;
+  }
+
+  if (args->argc == 2 && args->isStr(0, "test"))
+  {
+    uint8_t uart_ch;
+
+    uart_ch = constrain(args->getData(1), 1, UART_MAX_CH) - 1;
+
+    if (uartGetOwner(uart_ch) != NULL)
+    {
+      cliPrintf("_DEF_UART%d is used by %s\n", uart_ch + 1, uartGetOwner(uart_ch));
+    }
+    else if (uart_ch != cliGetPort())
+    {
+      uint8_t rx_data;
+      uint8_t rx_buf[16];
+      uint32_t rx_len;
+
+      while(1)
+      {
+        rx_len = uartReadBuf(uart_ch, rx_buf, sizeof(rx_buf));
+        for (uint32_t i=0; i<rx_len; i++)
+        {
+          cliPrintf("<- _DEF_UART%d RX : 0x%X\n", uart_ch + 1, rx_buf[i]);
+        }
+
+        if (cliAvailable() > 0)
+        {
+          rx_data = cliRead();
+          if (rx_data == 'q')
+          {
+            break;
+          }
+          else
+          {
+            uartWrite(uart_ch, &rx_data, 1);
+            cliPrintf("-> _DEF_UART%d TX : 0x%X\n", uart_ch + 1, rx_data);
+          }
         }
       }
     }
@@ -387,6 +1730,27 @@ void cliUart(cli_args_t *args)
     }
     ret = true;
   }
+  if (args->argc == 4 && args->isStr(0, "bench"))
+  {
+    uint8_t uart_ch;
+
+    uart_ch = constrain(args->getData(1), 1, UART_MAX_CH) - 1;
+
+    if (uartGetOwner(uart_ch) != NULL)
+    {
+      cliPrintf("_DEF_UART%d is used by %s\n", uart_ch + 1, uartGetOwner(uart_ch));
+    }
+    else if (uart_ch != cliGetPort())
+    {
+      uartBench(uart_ch, args->getStr(2), args->getData(3));
+    }
+    else
+    {
+      cliPrintf("This is cliPort\n");
+    }
+    ret = true;
+  }
+
   if (args->argc == 3 && args->isStr(0, "lin") && args->isStr(1, "test"))
   {
 	uint8_t uart_ch;
@@ -394,21 +1758,32 @@ void cliUart(cli_args_t *args)
   	uint8_t tx_lin_data[6] = {0x55, 0xD6, 0x11, 0x22, 0x33, 0xC2};
 
 	uart_ch = constrain(args->getData(2), 1, UART_MAX_CH) - 1;
-  	uartLinSendBreak(uart_ch);
-  	uartWrite(uart_ch, tx_lin_data, 6);
-	cliPrintf("-> _DEF_UART%d Send Lin Packet : ", uart_ch + 1);
-	for(uint8_t i=0;i<6;i++)
+	if (uartGetOwner(uart_ch) != NULL)
+	{
+		cliPrintf("_DEF_UART%d is used by %s\n", uart_ch + 1, uartGetOwner(uart_ch));
+	}
+	else
 	{
-		cliPrintf("%02X ", tx_lin_data[i]);
+		uartLinSendBreak(uart_ch);
+		uartWrite(uart_ch, tx_lin_data, 6);
+		cliPrintf("-> _DEF_UART%d Send Lin Packet : ", uart_ch + 1);
+		for(uint8_t i=0;i<6;i++)
+		{
+			cliPrintf("%02X ", tx_lin_data[i]);
+		}
+		cliPrintf("\n");
 	}
-	cliPrintf("\n");
 	ret = true;
   }
 
   if (ret == false)
   {
     cliPrintf("uart info\n");
+    cliPrintf("uart baud ch[1~%d] baud|auto\n", HW_UART_MAX_CH);
+    cliPrintf("uart de ch[1~%d] assert deassert\n", HW_UART_MAX_CH);
     cliPrintf("uart test ch[1~%d]\n", HW_UART_MAX_CH);
+    cliPrintf("uart bench ch[1~%d] tx|rx|echo ms\n", HW_UART_MAX_CH);
+    cliPrintf("uart bench ch[1~%d] rtt count[1~%d]\n", HW_UART_MAX_CH, UART_BENCH_RTT_MAX);
     cliPrintf("uart lin test ch[1~%d]\n", HW_UART_MAX_CH);
   }
 }
@@ -13,10 +13,21 @@ bool gpioInit(void);
 
 bool hwInit(void)
 {
+  bspInit();
+  qbufferInit();
   gpioInit();
   buttonInit();
   
   uartInit();
+#ifdef _USE_HW_LIN
+  linInit();
+#endif
+#ifdef _USE_HW_MODBUS
+  modbusInit();
+#endif
+#ifdef _USE_HW_PACKET
+  packetInit();
+#endif
   
   cliInit();
   logInit();
@@ -26,6 +37,12 @@ bool hwInit(void)
   {
     uartOpen(i, 115200);
   }
+#ifdef _USE_HW_LIN
+  linOpen(HW_LIN_CH, HW_LIN_BAUD);
+#endif
+#ifdef _USE_HW_MODBUS
+  modbusOpen(HW_MODBUS_CH, HW_MODBUS_BAUD, HW_MODBUS_ID);
+#endif
 
   logOpen(HW_UART_CH_DEBUG, 115200);
   logPrintf("\r\n[ Firmware Begin... ]\r\n");
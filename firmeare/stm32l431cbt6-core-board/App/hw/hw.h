@@ -7,8 +7,13 @@ extern "C" {
 
 #include "hw_def.h"
 
+#include "qbuffer.h"
+
 #include "led.h"
 #include "uart.h"
+#include "lin.h"
+#include "modbus.h"
+#include "packet.h"
 #include "log.h"
 #include "gpio.h"
 #include "cli.h"
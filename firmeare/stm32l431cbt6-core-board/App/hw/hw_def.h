@@ -8,17 +8,51 @@
 #define _DEF_FIRMWATRE_VERSION    "V250707R1"
 #define _DEF_BOARD_NAME           "STM32L431CBT6-CORE"
 
+#define _USE_HW_QBUFFER_STATS
+#define      HW_QBUFFER_STATS_MAX   8
+
 #define _USE_HW_LED
 #define      HW_LED_MAX_CH          1
 
 #define _USE_HW_UART
-#define      HW_UART_MAX_CH         1
+#define      HW_UART_MAX_CH         3
 #define      HW_UART_CH_DEBUG      	_DEF_UART1
+#define      HW_UART_CH_FIELD       _DEF_UART2
+#define      HW_UART_CH_MODEM       _DEF_UART3
+
+//#define _USE_HW_LIN                                   // HW_LIN_CH 는 MODBUS 와 다른 채널이어야 한다
+#define      HW_LIN_CH              HW_UART_CH_FIELD
+#define      HW_LIN_BAUD            19200
+#define      HW_LIN_SLOT_MAX        16
+
+#define _USE_HW_MODBUS
+#define      HW_MODBUS_CH           HW_UART_CH_FIELD
+#define      HW_MODBUS_BAUD         19200
+#define      HW_MODBUS_ID           1
+#define      HW_MODBUS_REG_MAX      64
+
+#if defined(_USE_HW_LIN) && defined(_USE_HW_MODBUS) && HW_LIN_CH == HW_MODBUS_CH
+#error "HW_LIN_CH and HW_MODBUS_CH use the same UART"
+#endif
+
+#define _USE_HW_PACKET
+#define      HW_PACKET_MAX_CH       1
+#define      HW_PACKET_DATA_MAX     128
 
 #define _USE_HW_LOG
 #define      HW_LOG_CH              HW_UART_CH_DEBUG
 #define      HW_LOG_BOOT_BUF_MAX    2048
 #define      HW_LOG_LIST_BUF_MAX    4096
+#define      HW_LOG_BOOT_LINE_MAX   64
+#define      HW_LOG_LIST_LINE_MAX   128
+#define      HW_LOG_RING_BUF_MAX    2048
+#define      HW_LOG_LINE_MAX        128
+//#define _USE_HW_LOG_TOKEN
+#ifdef DEBUG
+#define      HW_LOG_LEVEL           LOG_LEVEL_TRACE     // 모듈별로 HW_LOG_LEVEL_UART 처럼 따로 정할 수 있다
+#else
+#define      HW_LOG_LEVEL           LOG_LEVEL_INFO
+#endif
 
 #define _USE_HW_CLI
 #define      HW_CLI_CMD_LIST_MAX    32
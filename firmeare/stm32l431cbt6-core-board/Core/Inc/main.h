@@ -61,6 +61,8 @@ void Error_Handler(void);
 #define LED_GPIO_Port GPIOC
 #define BTN_Pin GPIO_PIN_15
 #define BTN_GPIO_Port GPIOC
+#define UART3_RTS_Pin GPIO_PIN_14
+#define UART3_RTS_GPIO_Port GPIOB
 
 /* USER CODE BEGIN Private defines */
 
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+# 토큰 로그(_USE_HW_LOG_TOKEN) 디코더
+#
+# - ELF 의 .log_fmt 섹션에서 토큰(섹션 안의 주소) 위치의 형식 문자열을 찾는다.
+# - UART 로 받은 SLIP 프레임(log.h 참고)을 풀어 인자를 넣어 출력하고,
+#   프레임 밖의 일반 텍스트 로그는 그대로 출력한다.
+#
+#   프레임 데이터 : [0x01][토큰 u16][시간 us u64][레벨 u8][인자 u32 x n] + CRC16 (상위 먼저)
+#
+# 사용 예
+#   python3 tools/log_decode.py Debug/stm32l431cbt6-core-board.elf capture.bin
+#   python3 tools/log_decode.py Debug/stm32l431cbt6-core-board.elf --port /dev/ttyUSB0 --baud 115200
+#   (--port 는 pyserial 필요)
+#
+import argparse
+import re
+import struct
+import sys
+
+
+SLIP_END     = 0xC0
+SLIP_ESC     = 0xDB
+SLIP_ESC_END = 0xDC
+SLIP_ESC_ESC = 0xDD
+
+FRAME_TYPE_TOKEN = 0x01
+
+LEVEL_STR = ["E", "W", "I", "D", "T"]
+
+
+# utilUpdateCrc() 와 같은 CRC16 (다항식 0x8005, MSB 먼저, 초기값 0xFFFF)
+#
+def make_crc_table():
+  table = []
+  for i in range(256):
+    crc = i << 8
+    for _ in range(8):
+      crc = ((crc << 1) ^ 0x8005) if (crc & 0x8000) else (crc << 1)
+    table.append(crc & 0xFFFF)
+  return table
+
+CRC_TABLE = make_crc_table()
+
+def crc16(data):
+  crc = 0xFFFF
+  for b in data:
+    crc = ((crc << 8) ^ CRC_TABLE[((crc >> 8) ^ b) & 0xFF]) & 0xFFFF
+  return crc
+
+
+# ELF(32/64 비트, 리틀 엔디안)에서 섹션 하나를 읽어 (주소, 데이터)를 돌려준다.
+#
+def read_elf_section(path, name):
+  with open(path, "rb") as f:
+    elf = f.read()
+
+  if elf[0:4] != b"\x7fELF":
+    raise ValueError("not an ELF file")
+  if elf[5] != 1:
+    raise ValueError("only little endian ELF is supported")
+
+  if elf[4] == 1:
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+    sh_fmt = "<IIIIIIIIII"
+  else:
+    shoff, = struct.unpack_from("<Q", elf, 0x28)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x3A)
+    sh_fmt = "<IIQQQQIIQQ"
+
+  sections = [struct.unpack_from(sh_fmt, elf, shoff + i * shentsize) for i in range(shnum)]
+  str_off  = sections[shstrndx][4]
+
+  for sh in sections:
+    sh_name = elf[str_off + sh[0]:elf.index(b"\0", str_off + sh[0])].decode()
+    if sh_name == name:
+      return sh[3], elf[sh[4]:sh[4] + sh[5]]
+
+  raise ValueError("section %s not found" % name)
+
+
+# C 형식 문자열을 파이썬 % 형식으로 바꾼다. 인자는 32비트 값이므로 길이 지정자는 버린다.
+#
+FMT_RE = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z|j|t)?([diuxXcop%])")
+
+def format_log(fmt, args):
+  out  = []
+  pos  = 0
+  args = list(args)
+
+  for m in FMT_RE.finditer(fmt):
+    out.append(fmt[pos:m.start()])
+    pos = m.end()
+
+    flags, width, prec, conv = m.groups()
+    if conv == "%":
+      out.append("%")
+      continue
+    if not args:
+      out.append(m.group(0))
+      continue
+
+    value = args.pop(0)
+    spec  = "%" + flags + width + ("." + prec if prec else "")
+    if conv in "di":
+      out.append((spec + "d") % (value - (1 << 32) if value & 0x80000000 else value))
+    elif conv == "c":
+      out.append((spec + "c") % chr(value & 0xFF))
+    elif conv == "p":
+      out.append((spec + "x") % value)
+    elif conv == "u":
+      out.append((spec + "d") % value)
+    else:
+      out.append((spec + conv) % value)
+
+  out.append(fmt[pos:])
+  return "".join(out)
+
+
+class LogDecoder:
+  def __init__(self, fmt_addr, fmt_data, out):
+    self.fmt_addr = fmt_addr
+    self.fmt_data = fmt_data
+    self.out      = out
+    self.in_frame = False
+    self.frame    = bytearray()
+    self.is_esc   = False
+    self.crc_err  = 0
+
+  def fmt_string(self, token):
+    offset = token - (self.fmt_addr & 0xFFFF)
+    if offset < 0 or offset >= len(self.fmt_data):
+      return None
+    end = self.fmt_data.find(b"\0", offset)
+    return self.fmt_data[offset:end].decode("utf-8", "replace")
+
+  def frame_done(self, data):
+    if len(data) < 2 or crc16(data) != 0:
+      self.crc_err += 1
+      self.out.write("<crc err, %d bytes>\n" % len(data))
+      return
+
+    data = data[:-2]
+    if len(data) < 12 or data[0] != FRAME_TYPE_TOKEN or (len(data) - 12) % 4 != 0:
+      self.out.write("<unknown frame, %d bytes>\n" % len(data))
+      return
+
+    token, time_us, level = struct.unpack_from("<HQB", data, 1)
+    args = struct.unpack_from("<%dI" % ((len(data) - 12) // 4), data, 12)
+
+    fmt = self.fmt_string(token)
+    if fmt is None:
+      text = "<token 0x%04X>%s\n" % (token, "".join(" 0x%X" % a for a in args))
+    else:
+      text = format_log(fmt, args)
+
+    level_str = LEVEL_STR[level] if level < len(LEVEL_STR) else str(level)
+    self.out.write("[%d.%06d] %s %s" % (time_us // 1000000, time_us % 1000000, level_str, text))
+
+  def feed(self, chunk):
+    text = bytearray()
+
+    for b in chunk:
+      if b == SLIP_END:
+        if self.in_frame and self.frame:
+          self.flush_text(text)
+          self.frame_done(bytes(self.frame))
+          self.in_frame = False
+        else:
+          self.in_frame = True
+        self.frame.clear()
+        self.is_esc = False
+        continue
+
+      if not self.in_frame:
+        text.append(b)
+        continue
+
+      if self.is_esc:
+        self.is_esc = False
+        if b == SLIP_ESC_END:
+          b = SLIP_END
+        elif b == SLIP_ESC_ESC:
+          b = SLIP_ESC
+      elif b == SLIP_ESC:
+        self.is_esc = True
+        continue
+      self.frame.append(b)
+
+    self.flush_text(text)
+
+  def flush_text(self, text):
+    if text:
+      self.out.write(text.decode("utf-8", "replace"))
+      text.clear()
+    self.out.flush()
+
+
+def main():
+  parser = argparse.ArgumentParser(description="tokenized log decoder")
+  parser.add_argument("elf", help="firmware ELF with the .log_fmt section")
+  parser.add_argument("input", nargs="?", default="-", help="captured UART bytes (default stdin)")
+  parser.add_argument("--port", help="read from a serial port instead (needs pyserial)")
+  parser.add_argument("--baud", type=int, default=115200)
+  args = parser.parse_args()
+
+  fmt_addr, fmt_data = read_elf_section(args.elf, ".log_fmt")
+  decoder = LogDecoder(fmt_addr, fmt_data, sys.stdout)
+
+  if args.port:
+    import serial
+
+    with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+      while True:
+        decoder.feed(port.read(256))
+  else:
+    f = sys.stdin.buffer if args.input == "-" else open(args.input, "rb")
+    with f:
+      while True:
+        chunk = f.read(4096)
+        if not chunk:
+          break
+        decoder.feed(chunk)
+
+
+if __name__ == "__main__":
+  try:
+    main()
+  except KeyboardInterrupt:
+    pass
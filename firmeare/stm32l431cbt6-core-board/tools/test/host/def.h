@@ -0,0 +1,41 @@
+#ifndef DEF_H_
+#define DEF_H_
+
+
+// PC 에서 App/common/core 와 순수 로직 드라이버를 빌드하기 위한 def.h 대체
+// - HAL/CMSIS 대신 표준 헤더만 쓰고, 코어 명령은 단일 스레드 기준으로 흉내 낸다.
+//
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+
+#define _DEF_UART1            0
+#define _DEF_UART2            1
+#define _DEF_UART3            2
+
+
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+#ifndef cmax
+#define cmax(a,b) (((a) > (b)) ? (a) : (b))
+#define cmin(a,b) (((a) < (b)) ? (a) : (b))
+#endif
+
+
+#define __DMB()                   __atomic_thread_fence(__ATOMIC_ACQ_REL)
+#define __CLREX()                 do { } while(0)
+#define __LDREXW(p)               (*(p))
+#define __STREXW(v, p)            (*(p) = (v), 0)
+
+
+typedef struct
+{
+  void *Instance;
+} UART_HandleTypeDef;
+
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef HW_DEF_H_
+#define HW_DEF_H_
+
+
+// PC 테스트용 hw_def.h, 테스트할 모듈만 켠다.
+//
+#include "def.h"
+
+
+#define _USE_HW_UART
+#define      HW_UART_MAX_CH         3
+#define      HW_UART_CH_FIELD       _DEF_UART2
+
+#define _USE_HW_MODBUS
+#define      HW_MODBUS_CH           HW_UART_CH_FIELD
+#define      HW_MODBUS_BAUD         19200
+#define      HW_MODBUS_ID           1
+#define      HW_MODBUS_REG_MAX      64
+
+
+#endif
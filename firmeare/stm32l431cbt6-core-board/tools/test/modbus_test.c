@@ -0,0 +1,235 @@
+// Modbus RTU 슬레이브 PC 테스트 : 모의 마스터가 요청 프레임을 가짜 UART 에 넣고
+// 수신 타임아웃 콜백(t3.5)을 불러 슬레이브 응답을 확인한다.
+//
+// gcc -O2 -Itools/test/host -IApp/common/core -IApp/common/hw/include
+//     tools/test/modbus_test.c App/hw/driver/modbus.c App/common/core/util.c -o modbus_test
+// ./modbus_test
+//
+#include "modbus.h"
+#include "uart.h"
+#include "util.h"
+
+
+#define TEST_ID         HW_MODBUS_ID
+
+
+static uint8_t  rx_buf[512];
+static uint32_t rx_len;
+static uint8_t  tx_buf[512];
+static uint32_t tx_len;
+static void   (*rto_func)(uint8_t ch);
+
+static uint32_t test_cnt;
+static uint32_t fail_cnt;
+
+
+// modbus.c 가 쓰는 uart 함수만 흉내 낸다.
+//
+bool uartOpen(uint8_t ch, uint32_t baud)
+{
+  return true;
+}
+
+bool uartSetOwner(uint8_t ch, const char *p_owner)
+{
+  return true;
+}
+
+bool uartSetRxTimeout(uint8_t ch, uint32_t bits, void (*p_func)(uint8_t ch))
+{
+  rto_func = p_func;
+  return true;
+}
+
+uint32_t uartAvailable(uint8_t ch)
+{
+  return rx_len;
+}
+
+void uartConsumeRx(uint8_t ch, uint32_t length)
+{
+  rx_len = 0;
+}
+
+uint32_t uartReadBuf(uint8_t ch, uint8_t *p_data, uint32_t length)
+{
+  length = cmin(length, rx_len);
+  memcpy(p_data, rx_buf, length);
+  rx_len = 0;
+
+  return length;
+}
+
+uint32_t uartWrite(uint8_t ch, uint8_t *p_data, uint32_t length)
+{
+  memcpy(&tx_buf[tx_len], p_data, length);
+  tx_len += length;
+
+  return length;
+}
+
+
+static uint32_t addCrc(uint8_t *p_data, uint32_t length)
+{
+  uint16_t crc = 0xFFFF;
+
+  for (uint32_t i=0; i<length; i++)
+  {
+    utilUpdateCrcModbus(&crc, p_data[i]);
+  }
+  p_data[length + 0] = crc >> 0;
+  p_data[length + 1] = crc >> 8;
+
+  return length + 2;
+}
+
+// 요청을 보내고 t3.5 가 지난 것처럼 콜백을 부른 뒤 응답 길이를 돌려준다.
+//
+static uint32_t masterRequest(const uint8_t *p_req, uint32_t length, bool bad_crc)
+{
+  memcpy(rx_buf, p_req, length);
+  rx_len = addCrc(rx_buf, length);
+  if (bad_crc)
+  {
+    rx_buf[rx_len - 1] ^= 0x01;
+  }
+
+  tx_len = 0;
+  rto_func(HW_MODBUS_CH);
+
+  return tx_len;
+}
+
+static void check(const char *p_name, bool pass)
+{
+  test_cnt++;
+  if (pass != true)
+  {
+    fail_cnt++;
+  }
+  printf("%-36s %s\n", p_name, pass ? "OK":"Fail");
+}
+
+// 응답 CRC 가 맞고 CRC 를 뺀 내용이 기대값과 같은지 확인한다.
+//
+static bool checkResp(const uint8_t *p_expect, uint32_t length)
+{
+  uint8_t  buf[256];
+  uint32_t len;
+
+  memcpy(buf, p_expect, length);
+  len = addCrc(buf, length);
+
+  return tx_len == len && memcmp(tx_buf, buf, len) == 0;
+}
+
+static uint8_t failRead(uint8_t type, uint16_t addr, uint16_t count, uint16_t *p_data)
+{
+  return MODBUS_EX_DEVICE_FAILURE;
+}
+
+static uint8_t failWrite(uint16_t addr, uint16_t count, const uint16_t *p_data)
+{
+  return MODBUS_EX_DEVICE_FAILURE;
+}
+
+
+int main(void)
+{
+  modbusInit();
+  check("open", modbusOpen(HW_MODBUS_CH, HW_MODBUS_BAUD, TEST_ID) == true && rto_func != NULL);
+
+  {
+    uint8_t req[]  = {TEST_ID, 0x06, 0x00, 0x05, 0x12, 0x34};
+
+    masterRequest(req, sizeof(req), false);
+    check("06 write single", checkResp(req, sizeof(req)));
+  }
+  {
+    uint8_t req[]  = {TEST_ID, 0x03, 0x00, 0x04, 0x00, 0x02};
+    uint8_t resp[] = {TEST_ID, 0x03, 0x04, 0x00, 0x00, 0x12, 0x34};
+
+    masterRequest(req, sizeof(req), false);
+    check("03 read holding", checkResp(resp, sizeof(resp)));
+  }
+  {
+    uint8_t req[]  = {TEST_ID, 0x10, 0x00, 0x10, 0x00, 0x03, 0x06, 0x00, 0x01, 0xAB, 0xCD, 0xFF, 0xFF};
+    uint8_t resp[] = {TEST_ID, 0x10, 0x00, 0x10, 0x00, 0x03};
+
+    masterRequest(req, sizeof(req), false);
+    check("10 write multiple", checkResp(resp, sizeof(resp)));
+  }
+  {
+    uint8_t req[]  = {TEST_ID, 0x04, 0x00, 0x10, 0x00, 0x03};
+    uint8_t resp[] = {TEST_ID, 0x04, 0x06, 0x00, 0x01, 0xAB, 0xCD, 0xFF, 0xFF};
+
+    masterRequest(req, sizeof(req), false);
+    check("04 read input", checkResp(resp, sizeof(resp)));
+  }
+  {
+    uint8_t req[]  = {TEST_ID, 0x10, 0x00, 0x00, 0x00, 0x02, 0x03, 0x00, 0x01, 0x00};
+    uint8_t resp[] = {TEST_ID, 0x90, MODBUS_EX_ILLEGAL_VALUE};
+
+    masterRequest(req, sizeof(req), false);
+    check("10 byte count mismatch -> ex 03", checkResp(resp, sizeof(resp)));
+  }
+  {
+    uint8_t req[]  = {TEST_ID, 0x2B, 0x0E, 0x01, 0x00};
+    uint8_t resp[] = {TEST_ID, 0xAB, MODBUS_EX_ILLEGAL_FUNCTION};
+
+    masterRequest(req, sizeof(req), false);
+    check("unknown function -> ex 01", checkResp(resp, sizeof(resp)));
+  }
+  {
+    uint8_t req[]  = {TEST_ID, 0x03, 0x00, HW_MODBUS_REG_MAX - 1, 0x00, 0x02};
+    uint8_t resp[] = {TEST_ID, 0x83, MODBUS_EX_ILLEGAL_ADDRESS};
+
+    masterRequest(req, sizeof(req), false);
+    check("read past map -> ex 02", checkResp(resp, sizeof(resp)));
+  }
+  {
+    uint8_t req[]  = {TEST_ID, 0x03, 0x00, 0x00, 0x00, 126};
+    uint8_t resp[] = {TEST_ID, 0x83, MODBUS_EX_ILLEGAL_VALUE};
+
+    masterRequest(req, sizeof(req), false);
+    check("read 126 regs -> ex 03", checkResp(resp, sizeof(resp)));
+  }
+  {
+    uint8_t req[]  = {TEST_ID, 0x03, 0x00, 0x00, 0x00, 0x01};
+
+    check("bad crc -> no reply", masterRequest(req, sizeof(req), true) == 0);
+  }
+  {
+    uint8_t req[]  = {TEST_ID + 1, 0x03, 0x00, 0x00, 0x00, 0x01};
+
+    check("other slave -> no reply", masterRequest(req, sizeof(req), false) == 0);
+  }
+  {
+    uint8_t req[]  = {0x00, 0x06, 0x00, 0x07, 0x55, 0xAA};
+    uint8_t rd[]   = {TEST_ID, 0x03, 0x00, 0x07, 0x00, 0x01};
+    uint8_t resp[] = {TEST_ID, 0x03, 0x02, 0x55, 0xAA};
+
+    check("broadcast write -> no reply", masterRequest(req, sizeof(req), false) == 0);
+    masterRequest(rd, sizeof(rd), false);
+    check("broadcast write applied", checkResp(resp, sizeof(resp)));
+  }
+  {
+    uint8_t req[]  = {TEST_ID};
+
+    check("short frame -> no reply", masterRequest(req, sizeof(req), false) == 0);
+  }
+  {
+    static const modbus_map_t map = {.read = failRead, .write = failWrite};
+    uint8_t req[]  = {TEST_ID, 0x06, 0x00, 0x00, 0x00, 0x01};
+    uint8_t resp[] = {TEST_ID, 0x86, MODBUS_EX_DEVICE_FAILURE};
+
+    modbusSetMap(&map);
+    masterRequest(req, sizeof(req), false);
+    check("map failure -> ex 04", checkResp(resp, sizeof(resp)));
+    modbusSetMap(NULL);
+  }
+
+  printf("\n%d/%d pass\n", test_cnt - fail_cnt, test_cnt);
+
+  return fail_cnt == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+// qbuffer PC 벤치마크 : 기존 바이트 루프 구현과 현재 구현(마스크 + memcpy)을 비교한다.
+//
+// gcc -O2 -Itools/test/host -IApp/common/core tools/test/qbuffer_bench.c App/common/core/qbuffer.c -o qbuffer_bench
+// ./qbuffer_bench
+//
+#include "qbuffer.h"
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+#define BENCH_BYTES     (16u * 1024u * 1024u)
+
+
+typedef bool (*bench_func_t)(qbuffer_t *p_node, uint8_t *p_data, uint32_t length);
+
+
+static uint64_t benchCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+// 변경 전 qbufferWrite()/qbufferRead() (요소마다 % 와 바이트 루프)
+//
+static bool legacyWrite(qbuffer_t *p_node, uint8_t *p_data, uint32_t length)
+{
+  bool ret = true;
+  uint32_t next_in;
+
+
+  for (uint32_t i=0; i<length; i++)
+  {
+    next_in = (p_node->in + 1) % p_node->len;
+
+    if (next_in != p_node->out)
+    {
+      if (p_node->p_buf != NULL && p_data != NULL)
+      {
+        uint8_t *p_buf;
+
+        p_buf = &p_node->p_buf[p_node->in*p_node->size];
+        for (uint32_t j=0; j<p_node->size; j++)
+        {
+          p_buf[j] = p_data[j];
+        }
+        p_data += p_node->size;
+      }
+      p_node->in = next_in;
+    }
+    else
+    {
+      ret = false;
+      break;
+    }
+  }
+
+  return ret;
+}
+
+static bool legacyRead(qbuffer_t *p_node, uint8_t *p_data, uint32_t length)
+{
+  bool ret = true;
+
+
+  for (uint32_t i=0; i<length; i++)
+  {
+    if (p_node->p_buf != NULL && p_data != NULL)
+    {
+      uint8_t *p_buf;
+
+      p_buf = &p_node->p_buf[p_node->out*p_node->size];
+      for (uint32_t j=0; j<p_node->size; j++)
+      {
+        p_data[j] = p_buf[j];
+      }
+      p_data += p_node->size;
+    }
+
+    if (p_node->out != p_node->in)
+    {
+      p_node->out = (p_node->out + 1) % p_node->len;
+    }
+    else
+    {
+      ret = false;
+      break;
+    }
+  }
+
+  return ret;
+}
+
+// chunk 바이트씩 쓰고 읽기를 반복해 BENCH_BYTES 를 통과시키고 바이트/사이클을 돌려준다.
+// 읽은 데이터가 쓴 순서와 같은지도 확인한다.
+//
+static double benchRun(bench_func_t write_func, bench_func_t read_func, uint32_t buf_len, uint32_t chunk, bool *p_ok)
+{
+  static uint8_t buf[8192];
+  uint8_t  tx[512];
+  uint8_t  rx[512];
+  qbuffer_t q;
+  uint64_t begin;
+  uint64_t cycles;
+  uint32_t seq_tx = 0;
+  uint32_t seq_rx = 0;
+
+
+  qbufferCreate(&q, buf, buf_len);
+
+  // 쓰기/읽기 위치가 버퍼 끝을 넘나들도록 한 번 밀어 둔다.
+  //
+  write_func(&q, tx, buf_len / 3);
+  read_func(&q, rx, buf_len / 3);
+
+  begin = benchCycles();
+  for (uint32_t done=0; done<BENCH_BYTES; done+=chunk)
+  {
+    for (uint32_t i=0; i<chunk; i++) tx[i] = seq_tx++;
+    write_func(&q, tx, chunk);
+    read_func(&q, rx, chunk);
+    for (uint32_t i=0; i<chunk; i++)
+    {
+      if (rx[i] != (uint8_t)seq_rx++) *p_ok = false;
+    }
+  }
+  cycles = benchCycles() - begin;
+
+  return (double)BENCH_BYTES / (double)cycles;
+}
+
+int main(void)
+{
+  const uint32_t len_tbl[]   = {1024, 1000};
+  const uint32_t chunk_tbl[] = {1, 4, 16, 64, 256};
+  bool ok = true;
+
+
+#if defined(__x86_64__) || defined(__i386__)
+  printf("unit : bytes/cycle (TSC)\n\n");
+#else
+  printf("unit : bytes/ns\n\n");
+#endif
+  printf("%-6s %-6s %10s %10s %8s\n", "len", "chunk", "legacy", "qbuffer", "ratio");
+
+  for (uint32_t l=0; l<sizeof(len_tbl)/sizeof(len_tbl[0]); l++)
+  {
+    for (uint32_t c=0; c<sizeof(chunk_tbl)/sizeof(chunk_tbl[0]); c++)
+    {
+      double legacy;
+      double cur;
+
+      legacy = benchRun(legacyWrite, legacyRead, len_tbl[l], chunk_tbl[c], &ok);
+      cur    = benchRun(qbufferWrite, qbufferRead, len_tbl[l], chunk_tbl[c], &ok);
+
+      printf("%-6u %-6u %10.3f %10.3f %7.1fx\n", len_tbl[l], chunk_tbl[c], legacy, cur, cur / legacy);
+    }
+  }
+
+  printf("\ndata : %s\n", ok ? "OK" : "Fail");
+
+  return ok ? 0 : 1;
+}
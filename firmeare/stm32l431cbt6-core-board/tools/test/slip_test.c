@@ -0,0 +1,191 @@
+// SLIP 코덱 PC 루프백 테스트 : 인코더 출력을 이어 붙인 바이트열을 디코더에 넣어
+// 프레임이 그대로 돌아오는지와 깨진 프레임을 버리는지 확인한다.
+//
+// gcc -O2 -Itools/test/host -IApp/common/core
+//     tools/test/slip_test.c App/common/core/slip.c App/common/core/util.c -o slip_test
+// ./slip_test
+//
+#include "slip.h"
+#include "util.h"
+
+
+#define TEST_DATA_MAX     128
+#define TEST_LOOP_CNT     10000
+
+
+static uint8_t  wire[64 * 1024];
+static uint32_t wire_len;
+
+static uint32_t test_cnt;
+static uint32_t fail_cnt;
+
+
+static void check(const char *p_name, bool pass)
+{
+  test_cnt++;
+  if (pass != true)
+  {
+    fail_cnt++;
+  }
+  printf("%-36s %s\n", p_name, pass ? "OK":"Fail");
+}
+
+static void encodeFrame(const uint8_t *p_data, uint32_t length)
+{
+  slip_enc_t enc;
+
+  wire_len += slipEncodeBegin(&enc, &wire[wire_len]);
+  for (uint32_t i=0; i<length; i++)
+  {
+    wire_len += slipEncodeByte(&enc, p_data[i], &wire[wire_len]);
+  }
+  wire_len += slipEncodeEnd(&enc, &wire[wire_len]);
+}
+
+// END/ESC 가 자주 나오도록 그 값을 섞는다.
+//
+static uint32_t makeFrame(uint8_t *p_data)
+{
+  uint32_t length;
+
+  length = 1 + rand() % TEST_DATA_MAX;
+  for (uint32_t i=0; i<length; i++)
+  {
+    uint32_t r = rand() % 8;
+
+    p_data[i] = (r == 0) ? SLIP_END : (r == 1) ? SLIP_ESC : rand();
+  }
+
+  return length;
+}
+
+// wire 를 디코딩해 완료된 프레임 수를 돌려준다.
+//
+static uint32_t decodeWire(slip_dec_t *p_dec)
+{
+  uint32_t frame_cnt = 0;
+
+  for (uint32_t i=0; i<wire_len; i++)
+  {
+    if (slipDecodeByte(p_dec, wire[i]) == true)
+    {
+      frame_cnt++;
+    }
+  }
+
+  return frame_cnt;
+}
+
+
+int main(void)
+{
+  slip_dec_t dec;
+  uint8_t    tx_buf[TEST_DATA_MAX];
+  uint8_t    rx_buf[TEST_DATA_MAX + SLIP_CRC_SIZE];
+
+
+  srand(1);
+  slipDecodeInit(&dec, rx_buf, sizeof(rx_buf));
+
+  // 무작위 프레임 루프백
+  //
+  {
+    uint32_t pass = 0;
+
+    for (uint32_t n=0; n<TEST_LOOP_CNT; n++)
+    {
+      uint32_t length;
+
+      length   = makeFrame(tx_buf);
+      wire_len = 0;
+      encodeFrame(tx_buf, length);
+
+      if (decodeWire(&dec) == 1 && dec.length == length && memcmp(tx_buf, rx_buf, length) == 0)
+      {
+        pass++;
+      }
+    }
+    printf("loopback %d/%d\n", pass, TEST_LOOP_CNT);
+    check("random frame loopback", pass == TEST_LOOP_CNT);
+  }
+
+  // 잡음 뒤의 프레임, 연속된 END 는 빈 프레임으로 무시
+  //
+  {
+    uint8_t data[] = {0x01, SLIP_END, 0x02, SLIP_ESC, 0x03};
+
+    wire_len = 0;
+    wire[wire_len++] = 0x55;
+    wire[wire_len++] = 0xAA;
+    wire[wire_len++] = SLIP_END;
+    wire[wire_len++] = SLIP_END;
+    encodeFrame(data, sizeof(data));
+
+    slipDecodeInit(&dec, rx_buf, sizeof(rx_buf));
+    check("noise then frame", decodeWire(&dec) == 1 && dec.length == sizeof(data) && memcmp(data, rx_buf, sizeof(data)) == 0);
+    check("noise counted as len err", dec.len_err == 1 && dec.crc_err == 0);
+  }
+
+  // 데이터 한 비트가 바뀌면 CRC 에러
+  //
+  {
+    uint8_t data[] = {0x10, 0x20, 0x30, 0x40};
+
+    wire_len = 0;
+    encodeFrame(data, sizeof(data));
+    wire[2] ^= 0x01;
+
+    slipDecodeInit(&dec, rx_buf, sizeof(rx_buf));
+    check("bit error -> crc err", decodeWire(&dec) == 0 && dec.crc_err == 1);
+  }
+
+  // ESC 뒤에 ESC_END/ESC_ESC 가 아니면 다음 END 까지 버린다.
+  //
+  {
+    uint8_t data[] = {0x10, 0x20};
+
+    wire_len = 0;
+    wire[wire_len++] = SLIP_END;
+    wire[wire_len++] = 0x11;
+    wire[wire_len++] = SLIP_ESC;
+    wire[wire_len++] = 0x00;
+    wire[wire_len++] = 0x22;
+    encodeFrame(data, sizeof(data));
+
+    slipDecodeInit(&dec, rx_buf, sizeof(rx_buf));
+    check("bad escape -> drop, resync", decodeWire(&dec) == 1 && dec.esc_err == 1 && dec.length == sizeof(data));
+  }
+
+  // 버퍼보다 긴 프레임은 버리고 다음 프레임은 받는다.
+  //
+  {
+    uint8_t big[TEST_DATA_MAX + SLIP_CRC_SIZE + 1];
+    uint8_t data[] = {0x77};
+
+    memset(big, 0x5A, sizeof(big));
+    wire_len = 0;
+    encodeFrame(big, sizeof(big));
+    encodeFrame(data, sizeof(data));
+
+    slipDecodeInit(&dec, rx_buf, sizeof(rx_buf));
+    check("overlong -> len err, resync", decodeWire(&dec) == 1 && dec.len_err == 1 && dec.length == 1 && rx_buf[0] == 0x77);
+  }
+
+  // 인코딩 크기 : 평범한 데이터는 4바이트 오버헤드
+  //
+  {
+    uint8_t data[64];
+
+    for (uint32_t i=0; i<sizeof(data); i++)
+    {
+      data[i] = i;
+    }
+    wire_len = 0;
+    encodeFrame(data, sizeof(data));
+    check("overhead 4 bytes", wire_len == sizeof(data) + 1 + SLIP_CRC_SIZE + 1);
+  }
+
+  printf("\n%d/%d pass\n", test_cnt - fail_cnt, test_cnt);
+
+  return fail_cnt == 0 ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+#!/usr/bin/env python3
+# 'uart bench' 호스트 드라이버
+#
+# - CLI 포트(시리얼 장치나 pty)로 'uart bench <ch> <mode> <param>' 을 보내고
+#   보드가 출력하는 "항목 : 값" 결과를 읽어 정리한다.
+# - --port 로 측정 채널에 연결된 호스트 쪽 포트를 주면 모드에 맞춰 상대 역할을 한다.
+#     tx   : 보드가 보내는 0,1,2.. 패턴을 받아 순서와 속도를 확인
+#     rx   : 0,1,2.. 패턴을 보드로 보낸다
+#     echo : 패턴을 chunk 단위로 보내고 되돌아오는 시간(왕복 지연, us)과 내용을 확인
+#     rtt  : 받은 바이트를 그대로 돌려보낸다 (보드가 지연을 잰다)
+#   --port 가 없으면 보드 쪽 루프백 점퍼 등으로 명령만 실행하고 결과를 읽는다.
+#
+# 사용 예
+#   python3 tools/uart_bench.py /dev/ttyUSB0 2 tx 1000 --port /dev/ttyUSB1 --baud 115200
+#   python3 tools/uart_bench.py /dev/pts/3 2 rtt 100 --port /dev/pts/5 --json
+#   (pyserial 없이 termios 로 연다. pty 는 속도 설정이 무시된다)
+#
+import argparse
+import json
+import os
+import re
+import select
+import sys
+import termios
+import time
+
+
+CLI_PROMPT     = b"cli# "
+CLI_TIMEOUT_S  = 2.0        # 명령 뒤 결과가 끝날 때까지 추가로 기다리는 시간
+START_DELAY_S  = 0.05       # 명령을 보낸 뒤 보드가 측정을 시작할 때까지 기다리는 시간
+END_MARGIN_S   = 0.2        # 보드 측정 시간이 끝나기 전에 호스트 송신을 멈추는 여유
+RTT_TIMEOUT_S  = 0.1        # UART_BENCH_RTT_TIMEOUT
+
+REPORT_RE = re.compile(r"^([a-z][a-z0-9 ]*?)\s+:\s+(.*)$")
+
+
+class Port:
+  def __init__(self, path, baud):
+    self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+
+    # raw 8N1, 블로킹 없이 읽는다.
+    #
+    attr = termios.tcgetattr(self.fd)
+    attr[0] = 0                                             # iflag
+    attr[1] = 0                                             # oflag
+    attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL  # cflag
+    attr[3] = 0                                             # lflag
+    speed = getattr(termios, "B%d" % baud, None)
+    if speed is not None:
+      attr[4] = speed
+      attr[5] = speed
+    attr[6][termios.VMIN]  = 0
+    attr[6][termios.VTIME] = 0
+    termios.tcsetattr(self.fd, termios.TCSANOW, attr)
+
+  def close(self):
+    os.close(self.fd)
+
+  def flush_input(self):
+    termios.tcflush(self.fd, termios.TCIFLUSH)
+    while self.read(0) != b"":
+      pass
+
+  def read(self, timeout):
+    r, _, _ = select.select([self.fd], [], [], timeout)
+    if not r:
+      return b""
+    try:
+      return os.read(self.fd, 4096)
+    except BlockingIOError:
+      return b""
+
+  def write(self, data, deadline=None):
+    view = memoryview(data)
+    while view:
+      if deadline is not None and time.monotonic() >= deadline:
+        return len(data) - len(view)
+      _, w, _ = select.select([], [self.fd], [], 0.05)
+      if not w:
+        continue
+      try:
+        view = view[os.write(self.fd, view):]
+      except BlockingIOError:
+        pass
+    return len(data)
+
+
+# 0,1,2.. 패턴의 연속성을 검사한다. 첫 바이트에서 시작 (보드 rx 와 같은 규칙)
+#
+class SeqCheck:
+  def __init__(self):
+    self.seq   = None
+    self.bytes = 0
+    self.err   = 0
+
+  def feed(self, data):
+    for b in data:
+      if self.seq is not None and b != self.seq:
+        self.err += 1
+      self.seq = (b + 1) & 0xFF
+    self.bytes += len(data)
+
+
+def pattern(start, length):
+  return bytes((start + i) & 0xFF for i in range(length))
+
+
+def percentile(values, p):
+  return values[min(len(values) - 1, len(values) * p // 100)]
+
+
+# 호스트 쪽 상대 역할. 보드 측정 시간(duration) 동안 동작하고 호스트 통계를 돌려준다.
+#
+def host_tx(port, duration, cli, cli_buf):
+  check = SeqCheck()
+  first = last = None
+  end   = time.monotonic() + duration + CLI_TIMEOUT_S
+
+  while time.monotonic() < end:
+    data = port.read(0.01)
+    if data:
+      now = time.monotonic()
+      first = first or now
+      last  = now
+      check.feed(data)
+    cli_buf += cli.read(0)
+    if cli_buf.endswith(CLI_PROMPT) and (last is None or time.monotonic() - last > 0.1):
+      break
+
+  elapsed = (last - first) if first and last else 0
+  return {"bytes": check.bytes, "seq err": check.err,
+          "rate": int(check.bytes / elapsed) if elapsed > 0 else 0}
+
+
+def host_rx(port, duration, chunk):
+  seq  = 0
+  sent = 0
+  end  = time.monotonic() + max(duration - END_MARGIN_S, 0.05)
+
+  while time.monotonic() < end:
+    n = port.write(pattern(seq, chunk), end)
+    seq  += n
+    sent += n
+  termios.tcdrain(port.fd)
+
+  return {"bytes": sent}
+
+
+def host_echo(port, duration, chunk):
+  seq     = 0
+  check   = SeqCheck()
+  rtt_us  = []
+  timeout = 0
+  end     = time.monotonic() + max(duration - END_MARGIN_S, 0.05)
+
+  while time.monotonic() < end:
+    data  = pattern(seq, chunk)
+    seq  += chunk
+    start = time.monotonic()
+    port.write(data)
+
+    rx = b""
+    while len(rx) < chunk and time.monotonic() - start < 0.5:
+      rx += port.read(0.01)
+    check.feed(rx)
+    if len(rx) < chunk:
+      timeout += 1
+      continue
+    rtt_us.append(int((time.monotonic() - start) * 1e6))
+
+  result = {"bytes": check.bytes, "seq err": check.err, "timeout": timeout, "samples": len(rtt_us)}
+  if rtt_us:
+    rtt_us.sort()
+    for name, p in (("min", 0), ("p50", 50), ("p90", 90), ("p99", 99)):
+      result["rtt " + name] = percentile(rtt_us, p)
+    result["rtt max"] = rtt_us[-1]
+  return result
+
+
+def host_rtt(port, count, cli, cli_buf):
+  echoed = 0
+  end    = time.monotonic() + count * RTT_TIMEOUT_S + CLI_TIMEOUT_S
+
+  while not cli_buf.endswith(CLI_PROMPT) and time.monotonic() < end:
+    data = port.read(0.001)
+    if data:
+      port.write(data)
+      echoed += len(data)
+    cli_buf += cli.read(0)
+
+  return {"bytes": echoed}
+
+
+# 명령 줄 이후의 "항목 : 값" 줄을 사전으로 만든다. 값의 첫 숫자는 "<항목>.n" 으로도 넣는다.
+#
+def parse_report(text):
+  report = {}
+
+  for line in text.replace("\r", "").split("\n"):
+    m = REPORT_RE.match(line.strip())
+    if not m:
+      continue
+    key, value = m.group(1).strip(), m.group(2).strip()
+    report[key] = value
+    num = re.match(r"-?\d+", value)
+    if num:
+      report[key + ".n"] = int(num.group(0))
+
+  return report
+
+
+def read_until_prompt(cli, cli_buf, timeout):
+  end = time.monotonic() + timeout
+  while not cli_buf.endswith(CLI_PROMPT) and time.monotonic() < end:
+    cli_buf += cli.read(0.05)
+  return cli_buf
+
+
+def main():
+  parser = argparse.ArgumentParser(description="drive 'uart bench' over the CLI port")
+  parser.add_argument("cli", help="CLI serial port or pty")
+  parser.add_argument("ch", type=int, help="bench channel (_DEF_UARTn, 1~)")
+  parser.add_argument("mode", choices=["tx", "rx", "echo", "rtt"])
+  parser.add_argument("param", type=int, help="ms for tx/rx/echo, count for rtt")
+  parser.add_argument("--cli-baud", type=int, default=115200)
+  parser.add_argument("--port", help="host side of the bench channel")
+  parser.add_argument("--baud", type=int, default=115200, help="bench channel baud")
+  parser.add_argument("--chunk", type=int, default=16, help="rx/echo write size")
+  parser.add_argument("--json", action="store_true", help="print one JSON object")
+  args = parser.parse_args()
+
+  cli  = Port(args.cli, args.cli_baud)
+  port = Port(args.port, args.baud) if args.port else None
+  host = {}
+
+  try:
+    # 이전 출력과 입력 줄을 비우고 프롬프트를 받는다.
+    #
+    cli.write(b"\r")
+    read_until_prompt(cli, bytearray(), 0.5)
+    cli.flush_input()
+    if port:
+      port.flush_input()
+
+    cmd = "uart bench %d %s %d" % (args.ch, args.mode, args.param)
+    cli.write((cmd + "\r").encode())
+    cli_buf  = bytearray()
+    duration = args.param / 1000.0
+
+    try:
+      if port and args.mode == "tx":
+        host = host_tx(port, duration, cli, cli_buf)
+      elif port and args.mode == "rx":
+        time.sleep(START_DELAY_S)
+        host = host_rx(port, duration, args.chunk)
+      elif port and args.mode == "echo":
+        time.sleep(START_DELAY_S)
+        host = host_echo(port, duration, args.chunk)
+      elif port and args.mode == "rtt":
+        host = host_rtt(port, args.param, cli, cli_buf)
+    except KeyboardInterrupt:
+      cli.write(b"q")
+
+    wait = CLI_TIMEOUT_S + (duration if args.mode != "rtt" else args.param * RTT_TIMEOUT_S)
+    cli_buf = read_until_prompt(cli, cli_buf, wait)
+  finally:
+    cli.close()
+    if port:
+      port.close()
+
+  # 에코된 명령 줄 뒤부터가 결과다.
+  #
+  text = cli_buf.decode("utf-8", "replace")
+  target = parse_report(text[text.find(cmd) + len(cmd):] if cmd in text else text)
+  if "bytes" not in target and "samples" not in target:
+    sys.stderr.write(cli_buf.decode("utf-8", "replace"))
+    sys.stderr.write("\nno bench report\n")
+    return 2
+
+  if args.json:
+    print(json.dumps({"mode": args.mode, "ch": args.ch, "target": target, "host": host}))
+  else:
+    print("target")
+    for key, value in target.items():
+      if not key.endswith(".n"):
+        print("  %-9s: %s" % (key, value))
+    if host:
+      print("host")
+      for key, value in host.items():
+        print("  %-9s: %s" % (key, value))
+
+  errors = target.get("seq err.n", 0) + target.get("timeout.n", 0) + host.get("seq err", 0) + host.get("timeout", 0)
+  return 1 if errors > 0 else 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())